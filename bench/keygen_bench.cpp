@@ -0,0 +1,92 @@
+// Secret key generation benchmark. Times the original generator, which opened and read
+// /dev/urandom for every key, against the ChaCha20 generator the store uses now, and
+// reports how evenly each spreads the colors.
+// Usage: ./keygen_bench [keys]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "../common/constants.hpp"
+#include "../server/utils/ChaCha20Rng.hpp"
+
+#define BENCH_KEYS 200000
+
+/// @brief Original key generator: one /dev/urandom read per key
+/// @param key Will store the secret key
+/// @return Whether /dev/urandom could be read
+bool urandomKey(std::string& key) {
+  key.assign(SECRET_KEY_LEN, '\0');
+  std::ifstream urandom("/dev/urandom", std::ios::in | std::ios::binary);
+  if (!urandom.is_open()) return false;
+
+  urandom.read(&key[0], SECRET_KEY_LEN);
+  if (!urandom) return false;
+
+  for (size_t i = 0; i < SECRET_KEY_LEN; ++i) {
+    key[i] = VALID_COLORS[static_cast<unsigned char>(key[i]) % strlen(VALID_COLORS)];
+  }
+  return true;
+}
+
+/// @brief Current key generator, as in `GameStore::generateKey`
+/// @param key Will store the secret key
+/// @return Always `true`
+bool chachaKey(std::string& key) {
+  thread_local ChaCha20Rng rng;
+  key.assign(SECRET_KEY_LEN, '\0');
+
+  for (size_t i = 0; i < SECRET_KEY_LEN; ++i) {
+    key[i] = VALID_COLORS[rng.uniform(VALID_COLORS_LEN)];
+  }
+  return true;
+}
+
+/// @brief Generates `keys` keys, printing ns per key and the largest deviation of a
+/// color's frequency from the uniform one
+/// @return Whether every key was generated
+template <typename Generate>
+bool run(const std::string& name, const size_t keys, Generate generate) {
+  size_t counts[VALID_COLORS_LEN] = {0};
+  std::string key;
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < keys; ++i) {
+    if (!generate(key)) {
+      std::cerr << name << ": key generation failed\n";
+      return false;
+    }
+    for (char color : key) {
+      counts[strchr(VALID_COLORS, color) - VALID_COLORS]++;
+    }
+  }
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  double expected = static_cast<double>(keys * SECRET_KEY_LEN) / VALID_COLORS_LEN;
+  double deviation = 0;
+  for (size_t count : counts) {
+    deviation = std::max(deviation, std::abs(count - expected) / expected);
+  }
+  std::cout << name << ": " << elapsed.count() / keys << " ns/key, max color deviation "
+            << deviation * 100 << "%\n";
+  return true;
+}
+
+int main(int argc, char** argv) {
+  size_t keys = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : BENCH_KEYS;
+  if (keys == 0) {
+    std::cerr << "Usage: " << argv[0] << " [keys]\n";
+    return 1;
+  }
+
+  std::cout << keys << " keys\n";
+  bool ok = run("/dev/urandom", keys, urandomKey);
+  ok = run("ChaCha20", keys, chachaKey) && ok;
+  return ok ? 0 : 1;
+}
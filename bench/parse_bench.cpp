@@ -0,0 +1,229 @@
+// Game file parsing benchmark. Writes a synthetic dataset of game files shaped like the
+// text backend's, then times parsing them with the original stream parser and with the
+// in-place parser, reading them with `read()`, mapping them and from memory.
+// Usage: ./parse_bench [games] [passes]
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../common/constants.hpp"
+#include "../common/scoring.hpp"
+#include "../common/utils.hpp"
+#include "../server/Game.hpp"
+#include "../server/exceptions/GameExceptions.hpp"
+#include "../server/utils/MappedFile.hpp"
+
+namespace fs = std::filesystem;
+
+#define BENCH_GAMES 20000
+#define BENCH_PASSES 5
+#define BENCH_TSTAMP_BASE 1734376356
+#define BENCH_SEED 2024
+
+/// @brief Generates a random game, finished unless `active`
+/// @param rng Random generator
+/// @param plid Player ID
+/// @param active Whether the game is still ongoing
+Game makeGame(std::mt19937& rng, const uint32_t plid, const bool active) {
+  std::uniform_int_distribution<uint> code(0, CODE_SPACE_SIZE - 1);
+  std::uniform_int_distribution<uint> play_time(30, 600);
+  std::uniform_int_distribution<uint> attempts(active ? 0 : 1, GUESSES_MAX);
+  std::uniform_int_distribution<uint> ending(0, 3);
+
+  GameMode mode = plid % 4 == 0 ? GameMode::DEBUG : GameMode::PLAY;
+  Game game(plid, static_cast<Code>(code(rng)), mode, play_time(rng),
+            BENCH_TSTAMP_BASE + plid);
+
+  uint num_attempts = attempts(rng);
+  uint time = 0;
+  for (uint i = 0; i < num_attempts; ++i) {
+    Code guess = static_cast<Code>(code(rng));
+    Feedback feedback = scoreCode(game.key, guess);
+    time += 1 + static_cast<uint>(rng() % (game.playTime / (GUESSES_MAX + 1)));
+    game.addAttempt(Attempt(guess, feedbackBlacks(feedback), feedbackWhites(feedback),
+                            time));
+  }
+
+  if (!active) {
+    game.status = Game::Status::FIN;
+    game.ending = static_cast<Endings>(ending(rng));
+    game.usedTime = static_cast<uint16_t>(time + 1);
+  }
+  return game;
+}
+
+/// @brief Original game file parser, on top of istreams
+/// @param file Game file
+/// @param game Will store the game
+void streamParseGame(std::istream& file, Game& game) {
+  std::string line;
+  std::getline(file, line);
+  std::istringstream header(line);
+  std::string plid_str, key_str, date, time;
+  char mode_char;
+
+  header >> plid_str >> mode_char >> key_str >> game.playTime;
+  header >> date >> time >> game.tstamp_start;
+  if (!header || !packCode(key_str, game.key)) {
+    throw InvalidGameFileException();
+  }
+  game.plid = strToPlid(plid_str);
+  game.mode = charToGameMode(mode_char);
+  game.numAttempts = 0;
+
+  while (std::getline(file, line)) {
+    if (line[0] == 'T') {
+      std::istringstream attempt(line);
+      std::string prefix;
+      uint blacks = 0, whites = 0, att_time = 0;
+      Code key;
+
+      attempt >> prefix >> key_str >> blacks >> whites >> att_time;
+      if (!packCode(key_str, key)) {
+        throw InvalidGameFileException();
+      }
+      game.addAttempt(Attempt(key, blacks, whites, att_time));
+    } else {
+      std::istringstream end(line);
+      end >> date >> time >> game.usedTime >> mode_char;
+      game.ending = charToEnding(mode_char);
+    }
+  }
+}
+
+/// @brief Serializes a game the way the text backend stores it
+/// @param game Game
+std::string serializeGame(const Game& game) {
+  std::ostringstream ss;
+  ss << game.serializeHeader();
+  for (uint i = 0; i < game.numAttempts; ++i) {
+    ss << game.attempts[i].serialize();
+  }
+
+  if (game.status == Game::Status::FIN) {
+    time_t tstamp_end = game.tstampEnd();
+    formatTimestamp(ss, &tstamp_end, TSTAMP_DATE_TIME_PRETTY);
+    ss << ' ' << game.usedTime << ' ' << endingToRepr(game.ending)[0] << '\n';
+  }
+  return ss.str();
+}
+
+/// @brief Checks a parsed game against the game it was generated from
+bool sameGame(const Game& a, const Game& b) {
+  if (a.plid != b.plid || a.key != b.key || a.mode != b.mode ||
+      a.playTime != b.playTime || a.tstamp_start != b.tstamp_start ||
+      a.numAttempts != b.numAttempts) {
+    return false;
+  }
+  if (b.status == Game::Status::FIN &&
+      (a.ending != b.ending || a.usedTime != b.usedTime)) {
+    return false;
+  }
+  for (uint i = 0; i < a.numAttempts; ++i) {
+    const Attempt& x = a.attempts[i];
+    const Attempt& y = b.attempts[i];
+    if (x.key != y.key || x.feedback != y.feedback || x.time != y.time) return false;
+  }
+  return true;
+}
+
+/// @brief Prints the throughput of a timed run
+void report(const std::string& name, const std::chrono::nanoseconds elapsed,
+            const size_t games, const size_t bytes) {
+  double secs = std::chrono::duration<double>(elapsed).count();
+  std::cout << name << ": " << static_cast<double>(elapsed.count()) / games
+            << " ns/game, " << games / secs / 1e6 << " Mgames/s, "
+            << bytes / secs / (1 << 20) << " MiB/s\n";
+}
+
+int main(int argc, char** argv) {
+  size_t num_games = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : BENCH_GAMES;
+  size_t passes = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : BENCH_PASSES;
+  if (num_games == 0 || num_games > PLID_MAX - 100000 || passes == 0) {
+    std::cerr << "Usage: " << argv[0] << " [games] [passes]\n";
+    return 1;
+  }
+
+  fs::path dir = fs::temp_directory_path() / ("parse_bench_" + std::to_string(getpid()));
+  fs::create_directories(dir);
+
+  std::mt19937 rng(BENCH_SEED);
+  std::vector<Game> games;
+  std::vector<std::string> contents;
+  std::vector<fs::path> paths;
+  size_t bytes = 0;
+
+  for (size_t i = 0; i < num_games; ++i) {
+    games.push_back(makeGame(rng, static_cast<uint32_t>(100000 + i), i % 10 == 0));
+    contents.push_back(serializeGame(games.back()));
+    paths.push_back(dir / ("GAME_" + plidToStr(games.back().plid) + ".txt"));
+    bytes += contents.back().size();
+
+    std::ofstream file(paths.back(), std::ios::binary);
+    file << contents.back();
+  }
+  std::cout << num_games << " games, " << bytes << " bytes, " << passes << " passes\n";
+
+  bool ok = true;
+  using clock = std::chrono::steady_clock;
+  std::chrono::nanoseconds stream{0}, read_files{0}, mapped{0}, in_memory{0};
+
+  for (size_t pass = 0; pass < passes && ok; ++pass) {
+    auto start = clock::now();
+    for (size_t i = 0; i < num_games; ++i) {
+      std::ifstream file(paths[i]);
+      Game game;
+      streamParseGame(file, game);
+      if (pass == 0) ok = ok && sameGame(game, games[i]);
+    }
+    stream += clock::now() - start;
+
+    start = clock::now();
+    std::string buffer;
+    for (size_t i = 0; i < num_games; ++i) {
+      Game game;
+      ok = readSmallFile(paths[i], buffer) && ok;
+      game.parseGame(buffer);
+      if (pass == 0) ok = ok && sameGame(game, games[i]);
+    }
+    read_files += clock::now() - start;
+
+    start = clock::now();
+    for (size_t i = 0; i < num_games; ++i) {
+      MappedFile file(paths[i]);
+      Game game;
+      game.parseGame(file.view());
+      if (pass == 0) ok = ok && sameGame(game, games[i]);
+    }
+    mapped += clock::now() - start;
+
+    start = clock::now();
+    for (size_t i = 0; i < num_games; ++i) {
+      Game game;
+      game.parseGame(contents[i]);
+      if (pass == 0) ok = ok && sameGame(game, games[i]);
+    }
+    in_memory += clock::now() - start;
+  }
+
+  fs::remove_all(dir);
+  if (!ok) {
+    std::cerr << "Parsed games differ from the generated ones\n";
+    return 1;
+  }
+
+  report("stream parser, files", stream, num_games * passes, bytes * passes);
+  report("read() files", read_files, num_games * passes, bytes * passes);
+  report("mapped files", mapped, num_games * passes, bytes * passes);
+  report("in memory", in_memory, num_games * passes, bytes * passes);
+  return 0;
+}
@@ -0,0 +1,140 @@
+// Scoring benchmark. Scores every guess against every key of the code space with the
+// original string algorithm, single table lookups, the scalar batch and the AVX2 batch,
+// checks that all of them agree and times each.
+// Usage: ./scoring_bench [passes]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../common/constants.hpp"
+#include "../common/scoring.hpp"
+
+#define BENCH_PASSES 20
+
+/// @brief Original scoring of an attempt, on the keys' string representation
+/// @param key Secret key
+/// @param att Guess
+/// @param whites Will store the number of whites
+/// @param blacks Will store the number of blacks
+void calculateAttempt(const std::string& key, const std::string& att, uint& whites,
+                      uint& blacks) {
+  const std::string valid_colors = VALID_COLORS;
+  uint key_count[VALID_COLORS_LEN] = {0};
+  uint att_count[VALID_COLORS_LEN] = {0};
+  blacks = 0;
+  whites = 0;
+
+  for (size_t i = 0; i < SECRET_KEY_LEN; ++i) {
+    if (key[i] == att[i]) {
+      blacks++;
+    } else {
+      key_count[valid_colors.find(key[i])]++;
+      att_count[valid_colors.find(att[i])]++;
+    }
+  }
+  for (size_t i = 0; i < VALID_COLORS_LEN; ++i) {
+    whites += std::min(key_count[i], att_count[i]);
+  }
+}
+
+/// @brief Times `passes` runs of a variant that scores every guess against `codes`
+/// into `out` (`CODE_SPACE_SIZE` rows), and prints ns per scored pair
+template <typename Score>
+void timeVariant(const std::string& name, const size_t passes, Score score) {
+  using clock = std::chrono::steady_clock;
+  auto start = clock::now();
+  for (size_t pass = 0; pass < passes; ++pass) {
+    for (uint guess = 0; guess < CODE_SPACE_SIZE; ++guess) {
+      score(static_cast<Code>(guess));
+    }
+  }
+  std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+  std::cout << name << ": "
+            << elapsed.count() / (static_cast<double>(passes) * CODE_SPACE_SIZE *
+                                  CODE_SPACE_SIZE)
+            << " ns/score\n";
+}
+
+int main(int argc, char** argv) {
+  size_t passes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : BENCH_PASSES;
+  if (passes == 0) {
+    std::cerr << "Usage: " << argv[0] << " [passes]\n";
+    return 1;
+  }
+
+  std::vector<Code> codes(CODE_SPACE_SIZE);
+  std::vector<std::string> strings(CODE_SPACE_SIZE);
+  for (uint i = 0; i < CODE_SPACE_SIZE; ++i) {
+    codes[i] = static_cast<Code>(i);
+    strings[i] = unpackCode(codes[i]);
+  }
+
+  // Reference scores, from the string algorithm
+  std::vector<Feedback> expected(CODE_SPACE_SIZE * CODE_SPACE_SIZE);
+  for (uint guess = 0; guess < CODE_SPACE_SIZE; ++guess) {
+    for (uint key = 0; key < CODE_SPACE_SIZE; ++key) {
+      uint whites, blacks;
+      calculateAttempt(strings[key], strings[guess], whites, blacks);
+      expected[guess * CODE_SPACE_SIZE + key] =
+          static_cast<Feedback>(blacks << 4 | whites);
+    }
+  }
+
+  std::vector<Feedback> out(CODE_SPACE_SIZE);
+  bool has_avx2 = scoreBatchAvx2(0, codes.data(), CODE_SPACE_SIZE, out.data());
+  bool ok = true;
+
+  auto check = [&](const std::string& name, auto score) {
+    for (uint guess = 0; guess < CODE_SPACE_SIZE && ok; ++guess) {
+      score(static_cast<Code>(guess));
+      for (uint key = 0; key < CODE_SPACE_SIZE; ++key) {
+        if (out[key] != expected[guess * CODE_SPACE_SIZE + key]) {
+          std::cerr << name << " scores " << strings[guess] << " against "
+                    << strings[key] << " differently\n";
+          ok = false;
+          break;
+        }
+      }
+    }
+  };
+
+  auto by_string = [&](Code guess) {
+    for (uint key = 0; key < CODE_SPACE_SIZE; ++key) {
+      uint whites, blacks;
+      calculateAttempt(strings[key], strings[guess], whites, blacks);
+      out[key] = static_cast<Feedback>(blacks << 4 | whites);
+    }
+  };
+  auto by_lookup = [&](Code guess) {
+    for (uint key = 0; key < CODE_SPACE_SIZE; ++key) {
+      out[key] = scoreCode(codes[key], guess);
+    }
+  };
+  auto by_scalar = [&](Code guess) {
+    scoreBatchScalar(guess, codes.data(), CODE_SPACE_SIZE, out.data());
+  };
+  auto by_avx2 = [&](Code guess) {
+    scoreBatchAvx2(guess, codes.data(), CODE_SPACE_SIZE, out.data());
+  };
+
+  check("scoreCode", by_lookup);
+  check("scoreBatchScalar", by_scalar);
+  if (has_avx2) check("scoreBatchAvx2", by_avx2);
+  if (!ok) return 1;
+
+  std::cout << CODE_SPACE_SIZE << "x" << CODE_SPACE_SIZE << " scores, " << passes
+            << " passes, all variants agree\n";
+  timeVariant("string", passes, by_string);
+  timeVariant("scoreCode", passes, by_lookup);
+  timeVariant("scoreBatchScalar", passes, by_scalar);
+  if (has_avx2) {
+    timeVariant("scoreBatchAvx2", passes, by_avx2);
+  } else {
+    std::cout << "scoreBatchAvx2: unavailable on this CPU\n";
+  }
+  return 0;
+}
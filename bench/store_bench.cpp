@@ -0,0 +1,205 @@
+// Storage benchmark. Drives a GameStore in-process from several client threads, each
+// playing whole games (start, two misses, a win, a last game lookup), and reports
+// throughput and per-operation latency for every storage backend and durability mode.
+// Being in-process, it measures the storage cost of a request without the network's.
+// Usage: ./store_bench [-s text|journal|memory|all] [-d none|sync|group|all]
+//                      [-t threads] [-n games]
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../common/Logger.hpp"
+#include "../common/constants.hpp"
+#include "../server/Game.hpp"
+#include "../server/GameStore.hpp"
+#include "../server/storage/Durability.hpp"
+#include "../server/storage/Storage.hpp"
+
+namespace fs = std::filesystem;
+using bench_clock = std::chrono::steady_clock;
+
+#define BENCH_THREADS 8
+#define BENCH_GAMES 2000
+#define BENCH_PLAY_TIME 600
+#define BENCH_PLID_BASE 100000
+#define BENCH_KEY "RGBY"
+
+/// @brief Plays `games` games on consecutive player IDs, recording every operation's
+/// latency (ns)
+/// @param store Game store
+/// @param first_plid First player ID
+/// @param games Number of games
+/// @param latencies Latency of every operation
+/// @return Number of games that did not end in a win
+size_t playGames(GameStore& store, const uint32_t first_plid, const size_t games,
+                 std::vector<uint64_t>& latencies) {
+  static const char* const trials[] = {"OOOO", "PPPP", BENCH_KEY};
+  std::string debug_key = BENCH_KEY;
+  size_t failed = 0;
+
+  auto timed = [&latencies](auto op) {
+    auto start = bench_clock::now();
+    auto result = op();
+    latencies.push_back(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - start)
+            .count()));
+    return result;
+  };
+
+  for (size_t i = 0; i < games; ++i) {
+    std::string plid = plidToStr(static_cast<uint32_t>(first_plid + i));
+    time_t now = time(nullptr);
+    timed([&] { return store.createGame(plid, now, BENCH_PLAY_TIME, &debug_key); });
+
+    uint blacks = 0, whites = 0;
+    std::string real_key;
+    for (uint trial = 1; trial <= 3; ++trial) {
+      timed([&] {
+        return store.attempt(plid, now, trials[trial - 1], trial, blacks, whites,
+                             real_key);
+      });
+    }
+    if (blacks != SECRET_KEY_LEN) failed++;
+
+    std::string output;
+    timed([&] { return store.getLastGame(plid, now, output); });
+  }
+  return failed;
+}
+
+/// @brief Returns the given percentile of sorted latencies (µs)
+double percentile(const std::vector<uint64_t>& sorted, const double p) {
+  size_t idx = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1));
+  return static_cast<double>(sorted[idx]) / 1e3;
+}
+
+/// @brief Runs the workload against a fresh store
+/// @return Whether every game was won
+bool run(const std::string& backend, const std::string& mode, const size_t num_threads,
+         const size_t games) {
+  fs::path dir = fs::temp_directory_path() / ("store_bench_" + std::to_string(getpid()) +
+                                              "_" + backend + "_" + mode);
+  fs::remove_all(dir);
+
+  std::vector<std::vector<uint64_t>> latencies(num_threads);
+  std::vector<size_t> failed(num_threads, 0);
+  std::chrono::nanoseconds elapsed;
+  uint64_t flushes;
+  {
+    Logger logger;
+    GameStore store(dir, strToStorageType(backend), strToDurabilityMode(mode),
+                    GAME_CACHE_BUDGET_KB * 1024, logger);
+    std::vector<std::thread> threads;
+    size_t per_thread = games / num_threads;
+
+    auto start = bench_clock::now();
+    for (size_t t = 0; t < num_threads; ++t) {
+      latencies[t].reserve(per_thread * 5);
+      threads.emplace_back([&, t] {
+        uint32_t first_plid = static_cast<uint32_t>(BENCH_PLID_BASE + t * per_thread);
+        failed[t] = playGames(store, first_plid, per_thread, latencies[t]);
+      });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    elapsed = bench_clock::now() - start;
+    flushes = store.getFlushCount();
+  }
+  fs::remove_all(dir);
+
+  std::vector<uint64_t> all;
+  size_t num_failed = 0;
+  for (size_t t = 0; t < num_threads; ++t) {
+    all.insert(all.end(), latencies[t].begin(), latencies[t].end());
+    num_failed += failed[t];
+  }
+  std::sort(all.begin(), all.end());
+
+  double secs = std::chrono::duration<double>(elapsed).count();
+  std::cout << std::fixed << std::setprecision(1) << std::left << std::setw(8) << backend
+            << std::setw(7) << mode << std::right << std::setw(12) << all.size() / secs
+            << " ops/s"
+            << "   p50 " << std::setw(9) << percentile(all, 0.50) << " us"
+            << "   p99 " << std::setw(9) << percentile(all, 0.99) << " us"
+            << "   max " << std::setw(9) << percentile(all, 1.0) << " us"
+            << std::setprecision(3) << "   flushes/op " << std::setw(5)
+            << static_cast<double>(flushes) / static_cast<double>(all.size()) << '\n';
+
+  if (num_failed != 0) {
+    std::cerr << backend << '/' << mode << ": " << num_failed
+              << " games were not won\n";
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  std::string backend = "all";
+  std::string mode = "all";
+  size_t num_threads = BENCH_THREADS;
+  size_t games = BENCH_GAMES;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "s:d:t:n:")) != -1) {
+    switch (opt) {
+      case 's':
+        backend = optarg;
+        break;
+      case 'd':
+        mode = optarg;
+        break;
+      case 't':
+        num_threads = std::strtoul(optarg, nullptr, 10);
+        break;
+      case 'n':
+        games = std::strtoul(optarg, nullptr, 10);
+        break;
+      default:
+        num_threads = 0;
+    }
+  }
+
+  std::vector<std::string> backends = {"text", "journal", "memory"};
+  std::vector<std::string> modes = {"none", "sync", "group"};
+  bool valid = num_threads != 0 && games >= num_threads &&
+               games <= PLID_MAX - BENCH_PLID_BASE;
+  try {
+    if (backend != "all") {
+      strToStorageType(backend);
+      backends = {backend};
+    }
+    if (mode != "all") {
+      strToDurabilityMode(mode);
+      modes = {mode};
+    }
+  } catch (const std::exception&) {
+    valid = false;
+  }
+  if (!valid) {
+    std::cerr << "Usage: " << argv[0] << " [-s text|journal|memory|all]"
+              << " [-d none|sync|group|all] [-t threads] [-n games]\n";
+    return 1;
+  }
+
+  std::cout << num_threads << " threads, " << games / num_threads * num_threads
+            << " games\n";
+
+  bool ok = true;
+  for (const std::string& b : backends) {
+    for (const std::string& m : modes) {
+      ok = run(b, m, num_threads, games) && ok;
+    }
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,240 @@
+// Concurrency stress test. Feeds whole player sessions (wins, losses and quits) through
+// the worker pool into one shared store at 1, 2, 4, ... worker threads, checks that every
+// player's last game, totals and the scoreboard match what was played, and reports how
+// throughput scales with the number of workers. Exits non-zero on any mismatch.
+// Usage: ./stress_bench [-s text|journal|memory] [-t max_threads] [-p players] [-g games]
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../common/Logger.hpp"
+#include "../common/constants.hpp"
+#include "../server/Game.hpp"
+#include "../server/GameStore.hpp"
+#include "../server/exceptions/GameExceptions.hpp"
+#include "../server/storage/Durability.hpp"
+#include "../server/storage/Storage.hpp"
+#include "../server/utils/WorkerPool.hpp"
+
+namespace fs = std::filesystem;
+
+#define BENCH_MAX_THREADS 8
+#define BENCH_PLAYERS 4000
+#define BENCH_GAMES 6
+#define BENCH_PLAY_TIME 600
+#define BENCH_PLID_BASE 100000
+#define BENCH_KEY "RGBY"
+
+enum Outcome { OUTCOME_WIN, OUTCOME_LOST, OUTCOME_QUIT, OUTCOME_COUNT };
+
+/// Wrong guesses against BENCH_KEY, all distinct
+static const char* const misses[GUESSES_MAX] = {"OOOO", "PPPP", "RRRR", "GGGG",
+                                                "BBBB", "YYYY", "OPOP", "POPO"};
+
+/// @brief Outcome of the `game`th game of the `player`th player
+Outcome outcomeOf(const size_t player, const size_t game) {
+  return static_cast<Outcome>((player + game) % OUTCOME_COUNT);
+}
+
+/// @brief Plays one player's games in order
+/// @param store Game store
+/// @param plid Player ID
+/// @param player Player index
+/// @param games Number of games
+/// @return Number of requests that did not behave as expected
+size_t playSession(GameStore& store, const std::string& plid, const size_t player,
+                   const size_t games) {
+  std::string debug_key = BENCH_KEY;
+  size_t errors = 0;
+
+  for (size_t g = 0; g < games; ++g) {
+    time_t now = time(nullptr);
+    Outcome outcome = outcomeOf(player, g);
+    uint blacks = 0, whites = 0;
+    std::string real_key;
+
+    try {
+      store.createGame(plid, now, BENCH_PLAY_TIME, &debug_key);
+
+      uint num_misses = outcome == OUTCOME_WIN    ? (player + g) % GUESSES_MAX
+                        : outcome == OUTCOME_LOST ? GUESSES_MAX
+                                                  : 2;
+      uint trial = 1;
+      for (; trial <= num_misses; ++trial) {
+        try {
+          store.attempt(plid, now, misses[trial - 1], trial, blacks, whites, real_key);
+        } catch (const ExceededMaxTrialsException&) {
+          if (outcome != OUTCOME_LOST || trial != GUESSES_MAX) errors++;
+        }
+      }
+
+      if (outcome == OUTCOME_WIN) {
+        store.attempt(plid, now, BENCH_KEY, trial, blacks, whites, real_key);
+        if (blacks != SECRET_KEY_LEN) errors++;
+      } else if (outcome == OUTCOME_QUIT) {
+        if (store.quitGame(plid, now) != BENCH_KEY) errors++;
+      }
+
+      std::string output;
+      if (store.getLastGame(plid, now, output) != Game::Status::FIN) errors++;
+    } catch (const std::exception&) {
+      errors++;
+    }
+  }
+  return errors;
+}
+
+/// @brief Checks every player's totals and the scoreboard against what was played
+/// @return Number of mismatches
+size_t verify(GameStore& store, const size_t players, const size_t games) {
+  size_t errors = 0;
+  size_t total_wins = 0;
+
+  for (size_t p = 0; p < players; ++p) {
+    size_t endings[OUTCOME_COUNT] = {0};
+    for (size_t g = 0; g < games; ++g) {
+      endings[outcomeOf(p, g)]++;
+    }
+    total_wins += endings[OUTCOME_WIN];
+
+    std::string expected = "Games played: " + std::to_string(games) +
+                           " (Wins: " + std::to_string(endings[OUTCOME_WIN]) +
+                           " | Losses: " + std::to_string(endings[OUTCOME_LOST]) +
+                           " | Quits: " + std::to_string(endings[OUTCOME_QUIT]) +
+                           " | Timeouts: 0)";
+    try {
+      std::string stats =
+          store.getPlayerStats(plidToStr(static_cast<uint32_t>(BENCH_PLID_BASE + p)));
+      if (stats.find(expected) == std::string::npos) errors++;
+    } catch (const std::exception&) {
+      errors++;
+    }
+  }
+
+  // Every game is a DEBUG game, so each scoreboard row ends in its mode
+  size_t expected_rows = std::min<size_t>(total_wins, SCOREBOARD_MAX_ENTRIES);
+  size_t rows = 0;
+  try {
+    uint64_t version;
+    std::string scoreboard = store.getScoreboard(version);
+    std::string row_end = gameModeToRepr(GameMode::DEBUG) + "\n";
+    for (size_t pos = scoreboard.find(row_end); pos != std::string::npos;
+         pos = scoreboard.find(row_end, pos + 1)) {
+      rows++;
+    }
+  } catch (const std::exception&) {
+  }
+  if (rows != expected_rows) errors++;
+
+  return errors;
+}
+
+/// @brief Runs every session on a fresh store with `num_threads` workers
+/// @return Games per second, or a negative value if the result does not check out
+double run(const StorageType type, const size_t num_threads, const size_t players,
+           const size_t games) {
+  fs::path dir = fs::temp_directory_path() /
+                 ("stress_bench_" + std::to_string(getpid()) + "_" +
+                  std::to_string(num_threads));
+  fs::remove_all(dir);
+
+  std::atomic<size_t> errors{0};
+  std::chrono::duration<double> elapsed;
+  {
+    Logger logger;
+    GameStore store(dir, type, DurabilityMode::NONE, GAME_CACHE_BUDGET_KB * 1024,
+                    logger);
+    auto start = std::chrono::steady_clock::now();
+    {
+      WorkerPool pool;
+      pool.dispatch(num_threads);
+      for (size_t p = 0; p < players; ++p) {
+        pool.enqueueConnection([&store, &errors, p, games] {
+          std::string plid = plidToStr(static_cast<uint32_t>(BENCH_PLID_BASE + p));
+          errors += playSession(store, plid, p, games);
+        });
+      }
+    }  // Drains the queue and joins the workers
+    elapsed = std::chrono::steady_clock::now() - start;
+
+    errors += verify(store, players, games);
+  }
+  fs::remove_all(dir);
+
+  if (errors != 0) {
+    std::cerr << num_threads << " threads: " << errors << " mismatches\n";
+    return -1;
+  }
+  return static_cast<double>(players * games) / elapsed.count();
+}
+
+int main(int argc, char** argv) {
+  std::string backend = "memory";
+  size_t max_threads = BENCH_MAX_THREADS;
+  size_t players = BENCH_PLAYERS;
+  size_t games = BENCH_GAMES;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "s:t:p:g:")) != -1) {
+    switch (opt) {
+      case 's':
+        backend = optarg;
+        break;
+      case 't':
+        max_threads = std::strtoul(optarg, nullptr, 10);
+        break;
+      case 'p':
+        players = std::strtoul(optarg, nullptr, 10);
+        break;
+      case 'g':
+        games = std::strtoul(optarg, nullptr, 10);
+        break;
+      default:
+        max_threads = 0;
+    }
+  }
+
+  StorageType type = StorageType::MEMORY;
+  try {
+    type = strToStorageType(backend);
+  } catch (const std::exception&) {
+    max_threads = 0;
+  }
+  if (max_threads == 0 || players == 0 || games == 0 ||
+      players > PLID_MAX - BENCH_PLID_BASE) {
+    std::cerr << "Usage: " << argv[0]
+              << " [-s text|journal|memory] [-t max_threads] [-p players] [-g games]\n";
+    return 1;
+  }
+
+  std::cout << backend << " backend, " << players << " players, " << games
+            << " games each, " << std::thread::hardware_concurrency() << " CPUs\n";
+
+  bool ok = true;
+  double base = 0;
+  for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+    double rate = run(type, threads, players, games);
+    if (rate < 0) {
+      ok = false;
+      continue;
+    }
+    if (base == 0) base = rate;
+    std::cout << std::fixed << std::setprecision(1) << std::setw(3) << threads
+              << " threads: " << std::setw(10) << rate << " games/s  (x"
+              << std::setprecision(2) << rate / base << ")\n";
+  }
+
+  if (ok) std::cout << "all sessions, totals and scoreboards check out\n";
+  return ok ? 0 : 1;
+}
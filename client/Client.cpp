@@ -17,6 +17,8 @@ void Client::registerCommands() {
   tcp_handlers.insert({"st", showTrialsHandler});
   tcp_handlers.insert({"scoreboard", showScoreboardHandler});
   tcp_handlers.insert({"sb", showScoreboardHandler});
+  tcp_handlers.insert({"stats", showStatsHandler});
+  tcp_handlers.insert({"history", showHistoryHandler});
 }
 
 /// @brief Calls the correct command handlers for TCP and UDP commands
@@ -31,7 +33,7 @@ void Client::handleCommand(std::string& command_id, std::stringstream& command_s
 
   auto tcp_cmd = tcp_handlers.find(command_id);
   if (tcp_cmd != tcp_handlers.end()) {
-    tcp_cmd->second(game_state, tcp_socket);
+    tcp_cmd->second(game_state, tcp_socket, command_stream);
     return;
   }
 
@@ -99,6 +101,8 @@ void Client::printHelp() {
     -> try <key>. Given an ongoing game, sends an attempt with that key. Check the key format below\n \
     -> show_trials, st: Shows information about your last played game. Must have an ongoing or finished game to have an associated PLID\n \
     -> scoreboard, sb: Shows the TOP 10 players and their corresponding results\n \
+    -> stats: Shows the totals of your finished games (played, endings, average attempts and best score)\n \
+    -> history [N] [offset]: Shows your last N (up to 20) finished games, skipping the offset most recent ones\n \
     -> debug <PLID> <MAXTIME> <key>: Starts a new debug game where you define the secret key\n \
     -> quit: Quits an ongoing game but not the player\n \
     -> exit: Exits the player\n\n \
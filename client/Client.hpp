@@ -13,7 +13,7 @@
 
 class Client {
   typedef void (*HandlerUdpFunc)(GameState&, UdpSocket&, std::stringstream&);
-  typedef void (*HandlerTcpFunc)(GameState&, TcpSocket&);
+  typedef void (*HandlerTcpFunc)(GameState&, TcpSocket&, std::stringstream&);
 
  private:
   TcpSocket tcp_socket;
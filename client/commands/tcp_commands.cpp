@@ -1,10 +1,12 @@
 #include "tcp_commands.hpp"
 
+#include <fstream>
+
 /// @brief Show trials handler. Sends the appropriate request and displays the last played
 /// or current game
 /// @param state Game state
 /// @param socket TcpSocket object
-void showTrialsHandler(GameState& state, TcpSocket& socket) {
+void showTrialsHandler(GameState& state, TcpSocket& socket, std::stringstream&) {
   ShowTrialsPacket request;
   ReplyShowTrialsPacket reply;
 
@@ -38,7 +40,7 @@ void showTrialsHandler(GameState& state, TcpSocket& socket) {
 /// scoreboard
 /// @param state Game state
 /// @param socket TcpSocket object
-void showScoreboardHandler(GameState& state, TcpSocket& socket) {
+void showScoreboardHandler(GameState& state, TcpSocket& socket, std::stringstream&) {
   ShowScoreboardPacket request;
   ReplyShowScoreboardPacket reply;
 
@@ -65,4 +67,122 @@ void showScoreboardHandler(GameState& state, TcpSocket& socket) {
   }
 
   socket.end();
-}
\ No newline at end of file
+}
+
+/// @brief Show stats handler. Sends the appropriate request and displays the totals of
+/// the player's finished games
+/// @param state Game state
+/// @param socket TcpSocket object
+void showStatsHandler(GameState& state, TcpSocket& socket, std::stringstream&) {
+  ShowStatsPacket request;
+  ReplyShowStatsPacket reply;
+
+  try {
+    request.playerID = state.getPlid();
+
+    socket.setup();
+
+    socket.sendPacket(&request);
+    socket.receivePacket(&reply);
+
+    switch (reply.status) {
+      case ReplyShowStatsPacket::OK:
+        state.saveFile(reply.fname, reply.fdata);
+        break;
+      case ReplyShowStatsPacket::NOK:
+      default:
+        throw BadCommandException();
+    }
+  } catch (const CommonException& e) {
+    std::cout << e.what() << std::endl;
+  } catch (const std::exception& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+  }
+
+  socket.end();
+}
+
+/// @brief Parses an optional history page argument (number of games or offset)
+/// @param command_stream User command stream
+/// @param value Will store the argument, if present
+/// @param min Minimum value
+/// @param max Maximum value
+static void parseHistoryArg(std::stringstream& command_stream, unsigned int& value,
+                            const long min, const long max) {
+  std::string arg;
+  if (!(command_stream >> arg)) {
+    return;
+  }
+
+  try {
+    size_t idx;
+    long parsed = std::stol(arg, &idx);
+    if (idx != arg.size() || parsed < min || parsed > max) {
+      throw InvalidHistoryPageException();
+    }
+    value = static_cast<unsigned int>(parsed);
+  } catch (const std::logic_error& e) {
+    throw InvalidHistoryPageException();
+  }
+}
+
+/// @brief Show history handler. Sends the appropriate request and displays a page of the
+/// player's finished games, saving each one to the file as soon as it arrives
+/// @param state Game state
+/// @param socket TcpSocket object
+/// @param command_stream User command stream
+void showHistoryHandler(GameState& state, TcpSocket& socket,
+                        std::stringstream& command_stream) {
+  ShowHistoryPacket request;
+  ReplyShowHistoryPacket reply;
+  std::ofstream file;
+  size_t games = 0;
+
+  try {
+    request.playerID = state.getPlid();
+    request.count = HISTORY_PAGE_MAX;
+    request.offset = 0;
+    parseHistoryArg(command_stream, request.count, 1, HISTORY_PAGE_MAX);
+    parseHistoryArg(command_stream, request.offset, 0, HISTORY_OFFSET_MAX);
+
+    reply.onGame = [&](const std::string& fdata) {
+      if (!file.is_open()) {
+        file.open(reply.fname, std::ios::trunc);
+        if (!file.is_open()) throw SaveFileError();
+      }
+
+      file << fdata;
+      if (!file) throw SaveFileError();
+
+      std::cout << fdata;
+      games++;
+    };
+
+    socket.setup();
+
+    socket.sendPacket(&request);
+    socket.receivePacket(&reply);
+
+    switch (reply.status) {
+      case ReplyShowHistoryPacket::OK:
+        if (games == 0) {
+          std::cout << "No finished games past the " << request.offset
+                    << " most recent ones (" << reply.total << " in total)" << std::endl;
+        } else {
+          std::cout << "\n    --- Finished games " << request.offset + 1 << " to "
+                    << request.offset + games << " of " << reply.total << " ---\n"
+                    << std::endl;
+        }
+        break;
+      case ReplyShowHistoryPacket::NOK:
+      default:
+        throw BadCommandException();
+    }
+  } catch (const CommonException& e) {
+    std::cout << e.what() << std::endl;
+  } catch (const std::exception& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+  }
+
+  socket.end();
+}
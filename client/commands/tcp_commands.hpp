@@ -4,8 +4,16 @@
 #include "../Client.hpp"
 #include "../exceptions/CommandExceptions.hpp"
 
-void showTrialsHandler(GameState& state, TcpSocket& socket);
+void showTrialsHandler(GameState& state, TcpSocket& socket,
+                       std::stringstream& command_stream);
 
-void showScoreboardHandler(GameState& state, TcpSocket& socket);
+void showScoreboardHandler(GameState& state, TcpSocket& socket,
+                           std::stringstream& command_stream);
+
+void showStatsHandler(GameState& state, TcpSocket& socket,
+                      std::stringstream& command_stream);
+
+void showHistoryHandler(GameState& state, TcpSocket& socket,
+                        std::stringstream& command_stream);
 
 #endif
\ No newline at end of file
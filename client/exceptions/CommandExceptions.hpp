@@ -76,6 +76,14 @@ class UncontextualizedException : public CommonException {
   UncontextualizedException() : CommonException(errorMsg) {};
 };
 
+class InvalidHistoryPageException : public CommonException {
+ private:
+  const std::string errorMsg = "Invalid history page! (1-20 games, offset 0-999999)";
+
+ public:
+  InvalidHistoryPageException() : CommonException(errorMsg) {};
+};
+
 class EmptyScoreboardException : public CommonException {
  private:
   const std::string errorMsg = "The scoreboard is still empty...";
@@ -17,6 +17,7 @@
 #define PLID_MAX 999999
 #define PLID_LEN 6
 #define SECRET_KEY_LEN 4
+#define CODE_SPACE_SIZE 1296  // VALID_COLORS_LEN ^ SECRET_KEY_LEN
 #define PACKET_ID_LEN 3
 #define STATUS_CODE_LEN 3
 #define PLAY_TIME_MAX 600
@@ -32,6 +33,18 @@
 
 // Server UDP settings
 #define SERVER_RECV_TIMEOUT 5
+#define UDP_WORKERS 8
+
+// Game store settings
+#define STORE_SHARDS 64
+#define GAME_CACHE_BUDGET_KB 4096  // Default size of the STR finished games cache
+
+// Game expiry timing wheel (one second ticks)
+#define TIMING_WHEEL_SLOTS 64
+#define TIMING_WHEEL_LEVELS 3
+
+// Secret key generator (per-thread ChaCha20)
+#define CSPRNG_RESEED_BYTES (1024 * 1024)
 
 // Client settings
 #define CLIENT_RECV_TIMEOUT 10
@@ -42,4 +55,31 @@
 #define FSIZE_MAX 2048
 #define FSIZE_STR_MAX 4
 
+// Player history (SHP): games per page and digits of the page offset and games total
+#define HISTORY_PAGE_MAX 20
+#define HISTORY_OFFSET_MAX 999999
+#define HISTORY_OFFSET_STR_MAX 6
+#define HISTORY_TOTAL_STR_MAX 10
+
+// Journal storage settings
+#define JOURNAL_RECORD_SIZE 128
+#define JOURNAL_SEGMENT_SIZE (4 * 1024 * 1024)
+
+// Snapshot settings (seconds between snapshots of the resident state)
+#define SNAPSHOT_INTERVAL 300
+
+// Finished games archiving (text storage)
+#define ARCHIVE_INTERVAL 60   // Seconds between compaction passes
+#define ARCHIVE_MIN_AGE 3600  // Seconds a finished game stays as a file of its own
+#define ARCHIVE_BATCH 1000    // Maximum games archived per pass
+
+// Score store (text storage), grown by this many 32 byte records at a time
+#define SCORE_STORE_GROW_RECORDS 32768
+
+// Write-behind queue of the text and journal storage (records written per batch)
+#define WRITE_BATCH_MAX 256
+
+// io_uring submission queue size of the journal writer (operations per io_uring_enter)
+#define IO_RING_ENTRIES 64
+
 #endif
\ No newline at end of file
@@ -19,4 +19,28 @@ class InvalidIPAddressException : public CommonException {
   InvalidIPAddressException() : CommonException(errorMsg) {};
 };
 
+class InvalidStorageException : public CommonException {
+ private:
+  const std::string errorMsg = "Storage type must be one of: text, memory, journal!";
+
+ public:
+  InvalidStorageException() : CommonException(errorMsg) {};
+};
+
+class InvalidDurabilityException : public CommonException {
+ private:
+  const std::string errorMsg = "Durability mode must be one of: none, sync, group!";
+
+ public:
+  InvalidDurabilityException() : CommonException(errorMsg) {};
+};
+
+class InvalidCacheBudgetException : public CommonException {
+ private:
+  const std::string errorMsg = "Cache budget must be a non-negative integer (KiB)!";
+
+ public:
+  InvalidCacheBudgetException() : CommonException(errorMsg) {};
+};
+
 #endif
\ No newline at end of file
@@ -109,6 +109,30 @@ unsigned short TcpParser::parseFileSize() {
   }
 }
 
+/// @brief Parses a decimal number followed by a delimiter
+/// @param max_digits Maximum number of digits
+/// @param end End delimiter
+/// @return Parsed number
+uint64_t TcpParser::parseNumber(size_t max_digits, char end) {
+  uint64_t number = 0;
+  size_t digits = 0;
+
+  while (true) {
+    char c;
+    safe_read(connection_fd, &c, sizeof(char));
+
+    if (c == end && digits > 0) {
+      return number;
+    }
+    if (!std::isdigit(static_cast<unsigned char>(c)) || digits == max_digits) {
+      throw InvalidPacketException();
+    }
+
+    number = number * 10 + static_cast<uint64_t>(c - '0');
+    digits++;
+  }
+}
+
 /// @brief Parses a file given its size
 /// @param file_size Expected file size
 /// @return Parsed file in string format
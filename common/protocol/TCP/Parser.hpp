@@ -30,6 +30,7 @@ class TcpParser {
   std::string parseFile(unsigned short file_size);
   std::string parsePlayerID();
   unsigned short parseFileSize();
+  uint64_t parseNumber(size_t max_digits, char end);
 };
 
 #endif
\ No newline at end of file
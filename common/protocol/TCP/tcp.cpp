@@ -124,6 +124,14 @@ void ReplyShowScoreboardPacket::read(int connection_fd) {
 }
 
 std::string ReplyShowScoreboardPacket::send(int connection_fd) const {
+  std::string encoded_str = encode();
+
+  safe_write(connection_fd, encoded_str.c_str(), encoded_str.size());
+
+  return encoded_str;
+}
+
+std::string ReplyShowScoreboardPacket::encode() const {
   std::ostringstream encoded_stream;
   encoded_stream << packetID << ' ' << statusToStr(status);
   switch (status) {
@@ -137,9 +145,176 @@ std::string ReplyShowScoreboardPacket::send(int connection_fd) const {
   }
 
   encoded_stream << '\n';
+  return encoded_stream.str();
+}
+
+void ShowStatsPacket::read(int connection_fd) {
+  TcpParser parser(connection_fd);
+
+  parser.next();
+  playerID = parser.parsePlayerID();
+  parser.end();
+}
+
+std::string ShowStatsPacket::send(int connection_fd) const {
+  std::ostringstream encoded_stream;
+  encoded_stream << packetID << ' ' << playerID << '\n';
+  std::string encoded_str = encoded_stream.str();
+
+  safe_write(connection_fd, encoded_str.c_str(), encoded_str.size());
+
+  return encoded_str;
+}
+
+void ReplyShowStatsPacket::read(int connection_fd) {
+  TcpParser parser(connection_fd);
+
+  std::string parsed_id = parser.parsePacketID();
+  if (parsed_id == TcpErrorPacket::packetID) {
+    throw ErrPacketException();
+  }
+  if (parsed_id != ReplyShowStatsPacket::packetID) {
+    throw InvalidPacketException();
+  }
+
+  parser.next();
+  std::string statusStr = parser.parseStatus();
+  if (statusStr == "NOK") {
+    status = NOK;
+  } else if (statusStr == "OK ") {
+    status = OK;
+
+    fname = parser.parseFileName();
+    fsize = parser.parseFileSize();
+    fdata = parser.parseFile(fsize);
+  } else {
+    throw InvalidPacketException();
+  }
+  parser.end();
+}
+
+std::string ReplyShowStatsPacket::send(int connection_fd) const {
+  std::ostringstream encoded_stream;
+  encoded_stream << packetID << ' ' << statusToStr(status);
+  switch (status) {
+    case ReplyShowStatsPacket::NOK:
+      break;
+    case ReplyShowStatsPacket::OK:
+      encoded_stream << ' ' << fname << ' ' << fsize << ' ' << fdata;
+      break;
+    default:
+      throw PacketEncodingException();
+  }
+
+  encoded_stream << '\n';
+  std::string encoded_str = encoded_stream.str();
+
+  safe_write(connection_fd, encoded_str.c_str(), encoded_str.size());
+
+  return encoded_str;
+}
+
+void ShowHistoryPacket::read(int connection_fd) {
+  TcpParser parser(connection_fd);
+
+  parser.next();
+  playerID = parser.parsePlayerID();
+  parser.next();
+  uint64_t parsed_count = parser.parseNumber(HISTORY_OFFSET_STR_MAX, ' ');
+  offset = static_cast<unsigned int>(parser.parseNumber(HISTORY_OFFSET_STR_MAX, '\n'));
+
+  if (parsed_count == 0 || parsed_count > HISTORY_PAGE_MAX) {
+    throw InvalidPacketException();
+  }
+  count = static_cast<unsigned int>(parsed_count);
+}
+
+std::string ShowHistoryPacket::send(int connection_fd) const {
+  std::ostringstream encoded_stream;
+  encoded_stream << packetID << ' ' << playerID << ' ' << count << ' ' << offset << '\n';
   std::string encoded_str = encoded_stream.str();
 
   safe_write(connection_fd, encoded_str.c_str(), encoded_str.size());
 
   return encoded_str;
 }
+
+void ReplyShowHistoryPacket::read(int connection_fd) {
+  TcpParser parser(connection_fd);
+
+  std::string parsed_id = parser.parsePacketID();
+  if (parsed_id == TcpErrorPacket::packetID) {
+    throw ErrPacketException();
+  }
+  if (parsed_id != ReplyShowHistoryPacket::packetID) {
+    throw InvalidPacketException();
+  }
+
+  parser.next();
+  std::string statusStr = parser.parseStatus();
+  if (statusStr == "NOK") {
+    status = NOK;
+    parser.end();
+    return;
+  } else if (statusStr != "OK ") {
+    throw InvalidPacketException();
+  }
+
+  status = OK;
+  fname = parser.parseFileName();
+  total = parser.parseNumber(HISTORY_TOTAL_STR_MAX, '\n');
+
+  while (true) {
+    uint64_t fsize = parser.parseNumber(FSIZE_STR_MAX, ' ');
+    if (fsize > FSIZE_MAX) {
+      throw InvalidPacketException();
+    }
+    if (fsize == 0) {
+      parser.end();
+      break;
+    }
+
+    std::string fdata = parser.parseFile(static_cast<unsigned short>(fsize));
+    parser.end();
+    if (onGame) onGame(fdata);
+  }
+}
+
+/// Games are written as `nextGame` produces them. Only the header and the number of
+/// games sent are returned (for logging)
+std::string ReplyShowHistoryPacket::send(int connection_fd) const {
+  std::ostringstream encoded_stream;
+  encoded_stream << packetID << ' ' << statusToStr(status);
+  switch (status) {
+    case ReplyShowHistoryPacket::NOK:
+      break;
+    case ReplyShowHistoryPacket::OK:
+      encoded_stream << ' ' << fname << ' ' << total;
+      break;
+    default:
+      throw PacketEncodingException();
+  }
+
+  encoded_stream << '\n';
+  std::string encoded_str = encoded_stream.str();
+
+  safe_write(connection_fd, encoded_str.c_str(), encoded_str.size());
+  if (status == ReplyShowHistoryPacket::NOK) {
+    return encoded_str;
+  }
+
+  size_t games = 0;
+  std::string fdata;
+  while (nextGame && nextGame(fdata)) {
+    if (fdata.empty() || fdata.size() > FSIZE_MAX) {
+      throw PacketEncodingException();
+    }
+
+    std::string chunk = std::to_string(fdata.size()) + ' ' + fdata + '\n';
+    safe_write(connection_fd, chunk.c_str(), chunk.size());
+    games++;
+  }
+  safe_write(connection_fd, "0 \n", 3);
+
+  return encoded_str + "(" + std::to_string(games) + " games)\n";
+}
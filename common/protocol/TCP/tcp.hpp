@@ -1,7 +1,9 @@
 #ifndef COMMON_PROTOCOL_TCP_PACKETS_HPP
 #define COMMON_PROTOCOL_TCP_PACKETS_HPP
 
+#include <functional>
 #include <iomanip>
+#include <memory>
 #include <string>
 
 #include "Parser.hpp"
@@ -78,6 +80,97 @@ class ReplyShowScoreboardPacket : public TcpPacket {
 
   void read(int connection_fd) override;
   std::string send(int connection_fd) const override;
+  std::string encode() const;
+};
+
+class ShowStatsPacket : public TcpPacket {
+ public:
+  static constexpr const char* packetID = "SPS";
+  std::string playerID;
+
+  void read(int connection_fd) override;
+  std::string send(int connection_fd) const override;
+};
+
+class ReplyShowStatsPacket : public TcpPacket {
+ public:
+  static constexpr const char* packetID = "RPS";
+  enum Status { OK, NOK };
+  Status status;
+  std::string fname;
+  std::string fdata;
+  unsigned short fsize;
+
+  std::string statusToStr(Status status) const {
+    switch (status) {
+      case OK:
+        return "OK";
+      case NOK:
+        return "NOK";
+      default:
+        throw PacketEncodingException();
+    }
+  };
+
+  void read(int connection_fd) override;
+  std::string send(int connection_fd) const override;
+};
+
+class ShowHistoryPacket : public TcpPacket {
+ public:
+  static constexpr const char* packetID = "SHP";
+  std::string playerID;
+  unsigned int count;   // Games in the page (1 to HISTORY_PAGE_MAX)
+  unsigned int offset;  // Most recent games skipped
+
+  void read(int connection_fd) override;
+  std::string send(int connection_fd) const override;
+};
+
+/// Streamed reply: the header is followed by one `<fsize> <fdata>` chunk per game, newest
+/// first, and an empty chunk. Games are produced and consumed one at a time, so a page is
+/// never held whole by either side
+class ReplyShowHistoryPacket : public TcpPacket {
+ public:
+  static constexpr const char* packetID = "RHP";
+  enum Status { OK, NOK };
+  Status status;
+  std::string fname;
+  uint64_t total;  // Finished games of the player
+
+  // Sending: stores the next game of the page, `false` once there are no more
+  std::function<bool(std::string&)> nextGame;
+  // Receiving: called with each game as soon as it is read
+  std::function<void(const std::string&)> onGame;
+
+  std::string statusToStr(Status status) const {
+    switch (status) {
+      case OK:
+        return "OK";
+      case NOK:
+        return "NOK";
+      default:
+        throw PacketEncodingException();
+    }
+  };
+
+  void read(int connection_fd) override;
+  std::string send(int connection_fd) const override;
+};
+
+/// Reply whose bytes were encoded beforehand, so they can be sent again without
+/// re-encoding (i.e: cached replies)
+class EncodedTcpPacket : public TcpPacket {
+ public:
+  std::shared_ptr<const std::string> data;
+
+  EncodedTcpPacket(std::shared_ptr<const std::string> data) : data(std::move(data)) {};
+
+  void read(int connection_fd) override { (void)connection_fd; };
+  std::string send(int connection_fd) const override {
+    safe_write(connection_fd, data->c_str(), data->size());
+    return *data;
+  };
 };
 
 class TcpErrorPacket : public TcpPacket {
@@ -0,0 +1,176 @@
+#include "scoring.hpp"
+
+#include <vector>
+
+#include "constants.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SCORING_HAS_AVX2_PATH
+#endif
+
+static_assert(CODE_SPACE_SIZE == VALID_COLORS_LEN * VALID_COLORS_LEN *
+                                     VALID_COLORS_LEN * VALID_COLORS_LEN,
+              "CODE_SPACE_SIZE must be VALID_COLORS_LEN ^ SECRET_KEY_LEN");
+
+/// @brief Scores a guess peg by peg. Only used to fill the feedback table
+/// @param key Secret key
+/// @param guess Guess
+/// @return Feedback
+static Feedback computeFeedback(Code key, Code guess) {
+  uint blacks = 0;
+  uint whites = 0;
+  uint key_count[VALID_COLORS_LEN] = {0};
+  uint guess_count[VALID_COLORS_LEN] = {0};
+
+  for (size_t i = 0; i < SECRET_KEY_LEN; ++i) {
+    uint key_peg = key % VALID_COLORS_LEN;
+    uint guess_peg = guess % VALID_COLORS_LEN;
+    key /= VALID_COLORS_LEN;
+    guess /= VALID_COLORS_LEN;
+
+    if (key_peg == guess_peg) {
+      blacks++;
+    } else {
+      key_count[key_peg]++;
+      guess_count[guess_peg]++;
+    }
+  }
+
+  for (size_t i = 0; i < VALID_COLORS_LEN; ++i) {
+    whites += (key_count[i] < guess_count[i]) ? key_count[i] : guess_count[i];
+  }
+
+  return static_cast<Feedback>((blacks << 4) | whites);
+}
+
+/// @brief Returns the `CODE_SPACE_SIZE` x `CODE_SPACE_SIZE` feedback table, row = guess
+/// and column = key. It is built on first use
+static const Feedback* feedbackTable() {
+  static const std::vector<Feedback> table = [] {
+    // Padded so a 32 bit gather at the last entry stays in bounds
+    std::vector<Feedback> t(CODE_SPACE_SIZE * CODE_SPACE_SIZE + 3);
+    for (Code guess = 0; guess < CODE_SPACE_SIZE; ++guess) {
+      for (Code key = 0; key < CODE_SPACE_SIZE; ++key) {
+        t[guess * CODE_SPACE_SIZE + key] = computeFeedback(key, guess);
+      }
+    }
+    return t;
+  }();
+
+  return table.data();
+}
+
+/// @brief Packs a code string (ex: "RGBY")
+/// @param str Code string, `SECRET_KEY_LEN` characters of `VALID_COLORS`
+/// @param code Will store the packed code
+/// @return `false` if `str` is not a valid code
+bool packCode(std::string_view str, Code& code) {
+  static constexpr std::string_view valid_colors = VALID_COLORS;
+
+  if (str.size() != SECRET_KEY_LEN) return false;
+
+  code = 0;
+  for (char c : str) {
+    size_t color = valid_colors.find(c);
+    if (color == std::string_view::npos) return false;
+    code = static_cast<Code>(code * VALID_COLORS_LEN + color);
+  }
+  return true;
+}
+
+/// @brief Unpacks a code into its string form
+/// @param code Packed code
+/// @return Code string
+std::string unpackCode(Code code) {
+  std::string str(SECRET_KEY_LEN, '\0');
+
+  for (size_t i = SECRET_KEY_LEN; i > 0; --i) {
+    str[i - 1] = VALID_COLORS[code % VALID_COLORS_LEN];
+    code /= VALID_COLORS_LEN;
+  }
+  return str;
+}
+
+/// @brief Scores a guess against a key
+/// @param key Secret key
+/// @param guess Guess
+/// @return Feedback
+Feedback scoreCode(const Code key, const Code guess) {
+  return feedbackTable()[guess * CODE_SPACE_SIZE + key];
+}
+
+/// Looks up the feedback of each code in the guess' table row
+static void scoreRow(const Feedback* row, const Code* codes, const size_t count,
+                     Feedback* out) {
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = row[codes[i]];
+  }
+}
+
+#ifdef SCORING_HAS_AVX2_PATH
+/// Gathers the feedback of 8 codes at a time from the guess' table row
+__attribute__((target("avx2"))) static void gatherRowAvx2(const Feedback* row,
+                                                           const Code* codes,
+                                                           const size_t count,
+                                                           Feedback* out) {
+  const __m256i low_byte = _mm256_set1_epi32(0xff);
+  size_t i = 0;
+
+  for (; i + 8 <= count; i += 8) {
+    __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(codes + i));
+    __m256i index = _mm256_cvtepu16_epi32(packed);
+    __m256i words =
+        _mm256_i32gather_epi32(reinterpret_cast<const int*>(row), index, 1);
+    words = _mm256_and_si256(words, low_byte);
+
+    __m128i halves = _mm_packus_epi32(_mm256_castsi256_si128(words),
+                                      _mm256_extracti128_si256(words, 1));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i),
+                     _mm_packus_epi16(halves, halves));
+  }
+
+  scoreRow(row, codes + i, count - i, out + i);
+}
+#endif
+
+/// @brief Scores one guess against many keys, one table lookup at a time
+/// @param guess Guess
+/// @param codes Keys to score against
+/// @param count Number of keys
+/// @param out Will store the `count` feedbacks
+void scoreBatchScalar(const Code guess, const Code* codes, const size_t count,
+                      Feedback* out) {
+  scoreRow(feedbackTable() + guess * CODE_SPACE_SIZE, codes, count, out);
+}
+
+/// @brief Scores one guess against many keys with AVX2 gathers
+/// @param guess Guess
+/// @param codes Keys to score against
+/// @param count Number of keys
+/// @param out Will store the `count` feedbacks
+/// @return `false` (and `out` untouched) if the build or the CPU lacks AVX2
+bool scoreBatchAvx2(const Code guess, const Code* codes, const size_t count,
+                    Feedback* out) {
+#ifdef SCORING_HAS_AVX2_PATH
+  static const bool has_avx2 = __builtin_cpu_supports("avx2");
+  if (has_avx2) {
+    gatherRowAvx2(feedbackTable() + guess * CODE_SPACE_SIZE, codes, count, out);
+    return true;
+  }
+#else
+  (void)guess, (void)codes, (void)count, (void)out;
+#endif
+  return false;
+}
+
+/// @brief Scores one guess against many keys. Uses AVX2 gathers when the CPU has them
+/// @param guess Guess
+/// @param codes Keys to score against
+/// @param count Number of keys
+/// @param out Will store the `count` feedbacks
+void scoreBatch(const Code guess, const Code* codes, const size_t count, Feedback* out) {
+  if (!scoreBatchAvx2(guess, codes, count, out)) {
+    scoreBatchScalar(guess, codes, count, out);
+  }
+}
@@ -0,0 +1,36 @@
+#ifndef COMMON_SCORING_HPP
+#define COMMON_SCORING_HPP
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/// A code (secret key or guess) packed as a base `VALID_COLORS_LEN` number, first peg
+/// being the most significant digit. Codes range over `[0, CODE_SPACE_SIZE)`
+typedef uint16_t Code;
+
+/// Score of a guess against a key: blacks in the high nibble, whites in the low nibble
+typedef uint8_t Feedback;
+
+bool packCode(std::string_view str, Code& code);
+
+std::string unpackCode(const Code code);
+
+inline uint feedbackBlacks(const Feedback feedback) { return feedback >> 4; }
+
+inline uint feedbackWhites(const Feedback feedback) { return feedback & 0x0f; }
+
+Feedback scoreCode(const Code key, const Code guess);
+
+void scoreBatch(const Code guess, const Code* codes, const size_t count, Feedback* out);
+
+void scoreBatchScalar(const Code guess, const Code* codes, const size_t count,
+                      Feedback* out);
+
+bool scoreBatchAvx2(const Code guess, const Code* codes, const size_t count,
+                    Feedback* out);
+
+#endif
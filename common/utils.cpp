@@ -62,14 +62,16 @@ ssize_t safe_write(int fd, const char* buffer, size_t n) {
 /// @param format formatting string (i.e: "%Y-%m-%d %HH:%MM:%SS")
 void formatTimestamp(std::ostringstream& ss, const time_t* tstamp,
                      const std::string& format) {
+  std::tm timeBuf;
   std::tm* timeInfo;
 
+  // localtime_r: timestamps are formatted concurrently by the server workers
   if (tstamp == nullptr) {
     auto now = std::chrono::system_clock::now();
     time_t time_now = std::chrono::system_clock::to_time_t(now);
-    timeInfo = std::localtime(&time_now);
+    timeInfo = localtime_r(&time_now, &timeBuf);
   } else {
-    timeInfo = std::localtime(tstamp);
+    timeInfo = localtime_r(tstamp, &timeBuf);
   }
 
   if (timeInfo) {
@@ -0,0 +1,269 @@
+#include "ActiveTable.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <new>
+
+#include "exceptions/ServerExceptions.hpp"
+
+#define ACTIVE_TABLE_SIZE \
+  (ACTIVE_TABLE_HEADER_SIZE + static_cast<size_t>(ACTIVE_TABLE_SLOTS) * sizeof(Game))
+
+static_assert(sizeof(ActiveTableHeader) <= ACTIVE_TABLE_HEADER_SIZE,
+              "The table header must fit in its page");
+
+/// @brief Returns the first slot of a mapping of the table
+static Game* slotsOf(void* mapping) {
+  return reinterpret_cast<Game*>(static_cast<char*>(mapping) + ACTIVE_TABLE_HEADER_SIZE);
+}
+
+/// @brief Opens the table file and maps it. A table closed cleanly by the previous run
+/// is restored, anything else is discarded (truncating drops every page, growing the
+/// file back leaves a hole of zeroed slots). An empty path keeps the table in an
+/// anonymous mapping instead, for backends that persist nothing
+/// @param path Table file path
+ActiveTable::ActiveTable(const std::filesystem::path& path)
+    : occupied(new std::atomic<uint64_t>[ACTIVE_TABLE_WORDS]) {
+  for (size_t i = 0; i < ACTIVE_TABLE_WORDS; ++i) {
+    occupied[i].store(0, std::memory_order_relaxed);
+  }
+
+  if (path.empty()) {
+    void* mapping = mmap(nullptr, ACTIVE_TABLE_SIZE, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mapping == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+    header = static_cast<ActiveTableHeader*>(mapping);
+    slots = slotsOf(mapping);
+    return;
+  }
+
+  fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (fd == -1) {
+    throw DBFilesystemError();
+  }
+
+  ActiveTableHeader saved{};
+  struct stat st;
+  bool usable = pread(fd, &saved, sizeof(saved), 0) == sizeof(saved) &&
+                fstat(fd, &st) == 0 &&
+                static_cast<size_t>(st.st_size) == ACTIVE_TABLE_SIZE &&
+                saved.magic == ACTIVE_TABLE_MAGIC &&
+                saved.version == ACTIVE_TABLE_VERSION && saved.slotSize == sizeof(Game) &&
+                saved.slots == ACTIVE_TABLE_SLOTS && saved.clean;
+  if (!usable && (ftruncate(fd, 0) == -1 ||
+                  ftruncate(fd, static_cast<off_t>(ACTIVE_TABLE_SIZE)) == -1)) {
+    ::close(fd);
+    throw DBFilesystemError();
+  }
+
+  void* mapping =
+      mmap(nullptr, ACTIVE_TABLE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (mapping == MAP_FAILED) {
+    ::close(fd);
+    throw DBFilesystemError();
+  }
+  madvise(mapping, ACTIVE_TABLE_SIZE, MADV_RANDOM);  // No readahead of unused slots
+  header = static_cast<ActiveTableHeader*>(mapping);
+  slots = slotsOf(mapping);
+
+  if (usable) {
+    restore();
+    isRestored = true;
+    restoredPosition = saved.position;
+  }
+
+  // From now on the slots may run ahead of the storage until the next clean close
+  header->magic = ACTIVE_TABLE_MAGIC;
+  header->version = ACTIVE_TABLE_VERSION;
+  header->slotSize = sizeof(Game);
+  header->slots = ACTIVE_TABLE_SLOTS;
+  header->position = 0;
+  header->clean = 0;
+  if (msync(header, ACTIVE_TABLE_HEADER_SIZE, MS_SYNC) == -1) {
+    munmap(mapping, ACTIVE_TABLE_SIZE);
+    ::close(fd);
+    throw DBFilesystemError();
+  }
+}
+
+/// @brief Unmaps and closes the table, without marking it clean
+ActiveTable::~ActiveTable() {
+  if (header != nullptr) {
+    munmap(header, ACTIVE_TABLE_SIZE);
+  }
+  if (fd != -1) {
+    ::close(fd);
+  }
+}
+
+/// @brief Rebuilds the occupancy bitmap from the slots of the file. Only its data
+/// extents are read, the holes left by never written (or punched) pages hold no game
+void ActiveTable::restore() {
+  const off_t end = static_cast<off_t>(ACTIVE_TABLE_SIZE);
+  off_t off = ACTIVE_TABLE_HEADER_SIZE;
+
+  while (off < end) {
+    off_t data = lseek(fd, off, SEEK_DATA);
+    if (data == -1) break;  // No data after `off`
+    off_t hole = lseek(fd, data, SEEK_HOLE);
+    if (hole == -1) hole = end;
+
+    // Every slot that overlaps the extent
+    size_t from = static_cast<size_t>(std::max<off_t>(data, ACTIVE_TABLE_HEADER_SIZE));
+    size_t to = static_cast<size_t>(hole);
+    size_t first = (from - ACTIVE_TABLE_HEADER_SIZE) / sizeof(Game);
+    size_t last = (to - ACTIVE_TABLE_HEADER_SIZE + sizeof(Game) - 1) / sizeof(Game);
+    last = std::min<size_t>(last, ACTIVE_TABLE_SLOTS);
+    for (size_t i = first; i < last; ++i) {
+      if (slots[i].status == Game::Status::ACT && slots[i].plid == i) {
+        occupied[i / 64].fetch_or(uint64_t{1} << (i % 64), std::memory_order_relaxed);
+      }
+    }
+    off = hole;
+  }
+}
+
+/// @brief Returns whether the active games were restored from the previous run
+/// @param position Will store the storage position they match
+bool ActiveTable::restored(uint64_t& position) const {
+  position = restoredPosition;
+  return isRestored;
+}
+
+/// @brief Removes every active game, when the restored ones don't match the storage
+void ActiveTable::discard() {
+  for (size_t i = 0; i < ACTIVE_TABLE_WORDS; ++i) {
+    uint64_t word = occupied[i].exchange(0, std::memory_order_relaxed);
+    while (word != 0) {
+      size_t bit = static_cast<size_t>(__builtin_ctzll(word));
+      slots[i * 64 + bit].status = Game::Status::FIN;
+      word &= word - 1;
+    }
+  }
+  isRestored = false;
+}
+
+/// @brief Gives the pages that hold no active game back to the file system, so the file
+/// stays sparse and the next restore only reads the pages in use. Erased slots are
+/// already marked as finished, so a page that can't be punched is merely read again
+void ActiveTable::punchEmptyPages() {
+  const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const size_t first_page = (ACTIVE_TABLE_HEADER_SIZE + page - 1) / page * page;
+  size_t run_start = 0, run_len = 0;
+
+  auto punch = [this, &run_len, &run_start] {
+    if (run_len != 0) {
+      fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                static_cast<off_t>(run_start), static_cast<off_t>(run_len));
+    }
+    run_len = 0;
+  };
+
+  for (size_t off = first_page; off < ACTIVE_TABLE_SIZE; off += page) {
+    size_t len = std::min(page, ACTIVE_TABLE_SIZE - off);
+    size_t lo = (off - ACTIVE_TABLE_HEADER_SIZE) / sizeof(Game);
+    size_t hi = (off + len - 1 - ACTIVE_TABLE_HEADER_SIZE) / sizeof(Game);
+    hi = std::min<size_t>(hi, ACTIVE_TABLE_SLOTS - 1);
+
+    bool empty = true;
+    for (size_t i = lo; i <= hi && empty; ++i) {
+      uint64_t word = occupied[i / 64].load(std::memory_order_relaxed);
+      empty = !(word & (uint64_t{1} << (i % 64)));
+    }
+
+    if (!empty) {
+      punch();
+    } else if (run_len == 0) {
+      run_start = off;
+      run_len = len;
+    } else {
+      run_len += len;
+    }
+  }
+  punch();
+}
+
+/// @brief Flushes the slots and marks the table clean, so the next start restores it.
+/// No slot may be modified afterwards
+/// @param position Storage position the slots match (every write flushed)
+void ActiveTable::close(const uint64_t position) {
+  if (fd == -1) return;
+
+  punchEmptyPages();
+  if (msync(header, ACTIVE_TABLE_SIZE, MS_SYNC) == -1) {
+    throw DBFilesystemError();
+  }
+
+  // The slots are on disk before the header claims they are complete
+  header->position = position;
+  header->clean = 1;
+  if (msync(header, ACTIVE_TABLE_HEADER_SIZE, MS_SYNC) == -1 || fsync(fd) == -1) {
+    throw DBFilesystemError();
+  }
+}
+
+/// @brief Looks up the active game of a player
+/// @param plid Player ID
+/// @return The game's slot, `nullptr` if the player has no active game
+Game* ActiveTable::find(const uint32_t plid) {
+  if (plid > PLID_MAX) return nullptr;
+
+  uint64_t word = occupied[plid / 64].load(std::memory_order_relaxed);
+  if (!(word & (uint64_t{1} << (plid % 64)))) return nullptr;
+  return &slots[plid];
+}
+
+/// @brief Stores a player's active game, replacing the previous one
+/// @param game Active game (`game.plid` must not exceed `PLID_MAX`)
+/// @return The game's slot
+Game& ActiveTable::insert(const Game& game) {
+  Game* slot = new (&slots[game.plid]) Game(game);
+  slot->status = Game::Status::ACT;
+  occupied[game.plid / 64].fetch_or(uint64_t{1} << (game.plid % 64),
+                                    std::memory_order_relaxed);
+  return *slot;
+}
+
+/// @brief Removes a player's active game. The slot is marked as finished too, so the
+/// file no longer holds it
+/// @param plid Player ID
+void ActiveTable::erase(const uint32_t plid) {
+  if (plid > PLID_MAX) return;
+
+  uint64_t bit = uint64_t{1} << (plid % 64);
+  if (occupied[plid / 64].fetch_and(~bit, std::memory_order_relaxed) & bit) {
+    slots[plid].status = Game::Status::FIN;
+  }
+}
+
+/// @brief Lists the active games of one GameStore shard (the players whose PLID modulo
+/// `STORE_SHARDS` is `shard`), by ascending PLID. None of their slots may be modified
+/// meanwhile (the shard's lock held)
+/// @param shard Shard index
+/// @return Copies of the active games
+std::vector<Game> ActiveTable::list(const uint32_t shard) const {
+  static_assert(64 % STORE_SHARDS == 0, "Shards must split every bitmap word evenly");
+  std::vector<Game> games;
+
+  // A shard owns the same bits of every word
+  uint64_t mask = 0;
+  for (uint32_t bit = shard; bit < 64; bit += STORE_SHARDS) {
+    mask |= uint64_t{1} << bit;
+  }
+
+  for (size_t i = 0; i < ACTIVE_TABLE_WORDS; ++i) {
+    uint64_t word = occupied[i].load(std::memory_order_relaxed) & mask;
+    while (word != 0) {
+      int bit = __builtin_ctzll(word);
+      games.push_back(slots[i * 64 + static_cast<size_t>(bit)]);
+      word &= word - 1;
+    }
+  }
+  return games;
+}
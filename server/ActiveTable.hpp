@@ -0,0 +1,67 @@
+#ifndef SERVER_ACTIVE_TABLE_HPP
+#define SERVER_ACTIVE_TABLE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "../common/constants.hpp"
+#include "Game.hpp"
+
+#define ACTIVE_TABLE_SLOTS (PLID_MAX + 1)
+#define ACTIVE_TABLE_WORDS ((ACTIVE_TABLE_SLOTS + 63) / 64)
+#define ACTIVE_TABLE_MAGIC 0x54434147  // "GACT"
+#define ACTIVE_TABLE_VERSION 1
+#define ACTIVE_TABLE_HEADER_SIZE 4096  // Slots start on the next page
+
+/// First page of the table file
+struct ActiveTableHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t slotSize;
+  uint32_t slots;
+  uint64_t position;  // Storage position the slots match, once closed cleanly
+  uint8_t clean;      // Set by `close`, cleared as soon as the table is opened
+};
+
+/// Active games, one fixed-size slot per PLID, directly indexed by the PLID (no hashing).
+/// The slots live in a sparse file the server keeps memory-mapped, so only the pages
+/// holding active games take memory and the page cache writes them back. On shutdown the
+/// table is flushed and marked clean with the storage position it matches, and the next
+/// start restores the active games from it instead of from storage. After a crash its
+/// pages may be older or newer than the storage, so it is rebuilt from storage instead.
+/// An occupancy bitmap tells which slots hold a game, so looking up a player without one
+/// or listing the active games doesn't touch every page. Callers serialize the accesses
+/// to a slot (the player's shard lock)
+class ActiveTable {
+ private:
+  int fd = -1;                         // -1: anonymous mapping, nothing on disk
+  ActiveTableHeader* header = nullptr;  // Mapping of the whole file
+  Game* slots = nullptr;
+  std::unique_ptr<std::atomic<uint64_t>[]> occupied;  // One bit per slot
+  bool isRestored = false;
+  uint64_t restoredPosition = 0;
+
+  void restore();
+  void punchEmptyPages();
+
+ public:
+  ActiveTable(const std::filesystem::path& path);
+  ~ActiveTable();
+
+  ActiveTable(const ActiveTable&) = delete;
+  ActiveTable& operator=(const ActiveTable&) = delete;
+
+  bool restored(uint64_t& position) const;
+  void discard();
+  void close(const uint64_t position);
+
+  Game* find(const uint32_t plid);
+  Game& insert(const Game& game);
+  void erase(const uint32_t plid);
+  std::vector<Game> list(const uint32_t shard) const;
+};
+
+#endif
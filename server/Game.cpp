@@ -0,0 +1,240 @@
+#include "Game.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "../common/constants.hpp"
+#include "../common/utils.hpp"
+#include "exceptions/GameExceptions.hpp"
+#include "utils/scan.hpp"
+
+/// @brief Returns the string representation of a GameMode
+/// @param mode  Gamemode
+std::string gameModeToRepr(const GameMode mode) {
+  switch (mode) {
+    case GameMode::PLAY:
+      return "PLAY";
+    case GameMode::DEBUG:
+      return "DEBUG";
+    default:
+      throw InvalidGameModeException();
+  }
+}
+
+/// @brief Returns the GameMode given the char representation
+/// @param c  Gamemode char
+GameMode charToGameMode(const char c) {
+  switch (c) {
+    case 'P':
+      return GameMode::PLAY;
+    case 'D':
+      return GameMode::DEBUG;
+    default:
+      throw InvalidGameModeException();
+  }
+}
+
+/// @brief Returns the string representation of an Ending
+/// @param ending Ending
+std::string endingToRepr(const Endings ending) {
+  switch (ending) {
+    case Endings::LOST:
+      return "LOST";
+    case Endings::WIN:
+      return "WIN";
+    case Endings::QUIT:
+      return "QUIT";
+    case Endings::TIMEOUT:
+      return "TIMEOUT";
+    default:
+      throw InvalidEndingException();
+  }
+}
+
+/// @brief Returns the Ending given the char representation
+/// @param c Ending char
+Endings charToEnding(const char c) {
+  switch (c) {
+    case 'L':
+      return Endings::LOST;
+    case 'W':
+      return Endings::WIN;
+    case 'Q':
+      return Endings::QUIT;
+    case 'T':
+      return Endings::TIMEOUT;
+    default:
+      throw InvalidEndingException();
+  }
+}
+
+/// @brief Parses a PLID into its integer representation
+/// @param str PLID (Ex: 100001)
+uint32_t strToPlid(const std::string& str) {
+  return static_cast<uint32_t>(std::stoul(str));
+}
+
+/// @brief Formats a PLID stored as an integer back to its string representation
+/// @param plid Player ID
+std::string plidToStr(const uint32_t plid) {
+  std::ostringstream ss;
+  ss << std::setw(PLID_LEN) << std::setfill('0') << plid;
+  return ss.str();
+}
+
+/// @brief Attempt object constructor.
+/// @param att Attempt in string format (Ex: T: GROG 4 0 123)
+Attempt::Attempt(std::string_view att) : key(0), feedback(0), time(0) {
+  std::string_view prefix;
+  std::string_view key_str;
+  uint blacks = 0;
+  uint whites = 0;
+
+  if (!nextToken(att, prefix) || !nextToken(att, key_str) || !nextNumber(att, blacks) ||
+      !nextNumber(att, whites) || !nextNumber(att, time) || !packCode(key_str, key)) {
+    throw InvalidGameFileException();
+  }
+  feedback = static_cast<Feedback>((blacks << 4) | whites);
+}
+
+/// @brief Serializes the attempt
+/// @return Serialized attempt in string format
+std::string Attempt::serialize() const {
+  std::ostringstream att_ss;
+  att_ss << "T: " << unpackCode(key) << ' ' << blacks() << ' ' << whites() << ' ' << time
+         << '\n';
+
+  return att_ss.str();
+};
+
+/// @brief Appends an attempt. Games hold at most `GUESSES_MAX` attempts
+/// @param attempt New attempt
+void Game::addAttempt(const Attempt& attempt) {
+  if (numAttempts < GUESSES_MAX) {
+    attempts[numAttempts++] = attempt;
+  }
+}
+
+/// @brief Parses the header of game file. (Ex: 100001 D RGBY 100 2024-12-16 19:12:36
+/// 1734376356)
+/// @param header First line of the game file
+void Game::parseHeader(std::string_view header) {
+  std::string_view key_str, date, time;
+  char mode_char;
+
+  // The date and time are derived from the timestamp
+  if (!nextNumber(header, plid) || !nextChar(header, mode_char) ||
+      !nextToken(header, key_str) || !nextNumber(header, playTime) ||
+      !nextToken(header, date) || !nextToken(header, time) ||
+      !nextNumber(header, tstamp_start) || !packCode(key_str, key)) {
+    throw InvalidGameFileException();
+  }
+  mode = charToGameMode(mode_char);
+  numAttempts = 0;
+}
+
+/// @brief Parses an entire Game file in place
+/// @param contents Game file contents (Ex: a mapped game file)
+void Game::parseGame(std::string_view contents) {
+  std::string_view line;
+  if (!nextLine(contents, line)) {
+    throw InvalidGameFileException();
+  }
+  parseHeader(line);
+
+  while (nextLine(contents, line)) {
+    if (line.empty()) continue;
+
+    if (line[0] == 'T') {
+      addAttempt(Attempt(line));
+    } else {
+      std::string_view date, time;
+      char mode_char;
+
+      // The date and time are always `tstamp_start + usedTime`
+      if (!nextToken(line, date) || !nextToken(line, time) ||
+          !nextNumber(line, usedTime) || !nextChar(line, mode_char)) {
+        throw InvalidGameFileException();
+      }
+      ending = charToEnding(mode_char);
+    }
+  }
+}
+
+/// @brief Serializes the game header
+/// @return The game's header in string format
+std::string Game::serializeHeader() const {
+  std::ostringstream header_ss;
+
+  header_ss << plidToStr(plid) << ' ';
+  header_ss << gameModeToRepr(mode)[0] << ' ';
+  header_ss << unpackCode(key) << ' ';
+  header_ss << playTime << ' ';
+  formatTimestamp(header_ss, &tstamp_start, TSTAMP_DATE_TIME_PRETTY);
+  header_ss << ' ' << tstamp_start << '\n';
+
+  return header_ss.str();
+}
+
+/// @brief Returns the number of finished games
+uint32_t PlayerStats::played() const {
+  return endings[WIN] + endings[LOST] + endings[QUIT] + endings[TIMEOUT];
+}
+
+/// @brief Accounts for a finished game
+/// @param ending Ending reason
+/// @param num_attempts Attempts made in the game
+void PlayerStats::addGame(const Endings ending, const uint num_attempts) {
+  if (ending < endings.size()) {
+    endings[ending]++;
+  }
+  attempts += num_attempts;
+}
+
+/// @brief Accounts for the score of a won game
+/// @param score Score
+void PlayerStats::addScore(const int score) { bestScore = std::max(bestScore, score); }
+
+/// @brief Parses a leaderboard entry
+/// @param line Score file header (Ex: 085 100001 RGBY 3 P)
+/// @return `false` if the line is not a valid entry
+bool LeaderboardEntry::parse(std::string_view line) {
+  std::string_view plid_str, key_str;
+  char mode_char;
+
+  if (!nextNumber(line, score) || !nextToken(line, plid_str) ||
+      !nextToken(line, key_str) || !nextNumber(line, used_atts) ||
+      !nextChar(line, mode_char)) {
+    return false;
+  }
+  plid = plid_str;
+  key = key_str;
+
+  try {
+    mode = charToGameMode(mode_char);
+  } catch (const InvalidGameModeException& e) {
+    return false;
+  }
+  return true;
+}
+
+/// @brief Serializes the entry as a score file header
+/// @return Serialized entry in string format
+std::string LeaderboardEntry::serialize() const {
+  std::ostringstream entry_ss;
+  entry_ss << score << ' ' << plid << ' ' << key << ' ' << used_atts << ' '
+           << gameModeToRepr(mode)[0] << '\n';
+
+  return entry_ss.str();
+}
+
+/// @brief Leaderboard ordering: higher score first, ties broken by descending PLID
+/// @param other Entry to compare with
+bool LeaderboardEntry::isBetterThan(const LeaderboardEntry& other) const {
+  if (score != other.score) {
+    return score > other.score;
+  }
+  return plid > other.plid;
+}
@@ -0,0 +1,107 @@
+#ifndef SERVER_GAME_HPP
+#define SERVER_GAME_HPP
+
+#include <array>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+#include "../common/constants.hpp"
+#include "../common/scoring.hpp"
+
+enum GameMode : uint8_t { PLAY, DEBUG };
+enum Endings : uint8_t { WIN, LOST, QUIT, TIMEOUT };
+
+uint32_t strToPlid(const std::string& str);
+std::string plidToStr(const uint32_t plid);
+
+std::string gameModeToRepr(const GameMode mode);
+GameMode charToGameMode(const char c);
+
+std::string endingToRepr(const Endings ending);
+Endings charToEnding(const char c);
+
+class LeaderboardEntry {
+ public:
+  int score;
+  std::string plid;
+  std::string key;
+  uint used_atts;
+  GameMode mode;
+
+  LeaderboardEntry() = default;
+  LeaderboardEntry(const int score, const std::string& plid, const std::string& key,
+                   const uint used_atts, const GameMode mode)
+      : score(score), plid(plid), key(key), used_atts(used_atts), mode(mode) {};
+
+  bool parse(std::string_view line);
+  std::string serialize() const;
+  bool isBetterThan(const LeaderboardEntry& other) const;
+};
+
+/// Totals of the finished games of a player, updated as its games end
+struct PlayerStats {
+  std::array<uint32_t, 4> endings{};  // Finished games by ending (indexed by Endings)
+  uint32_t attempts = 0;              // Attempts made over every finished game
+  int32_t bestScore = -1;             // -1: never won
+
+  uint32_t played() const;
+  void addGame(const Endings ending, const uint num_attempts);
+  void addScore(const int score);
+};
+
+/// A trial of a game, packed into 6 bytes
+class Attempt {
+ public:
+  Code key;
+  Feedback feedback;
+  uint16_t time;  // Seconds since the start of the game
+
+  Attempt() = default;
+  Attempt(std::string_view att);
+  Attempt(const Code key, const uint blacks, const uint whites, const uint time)
+      : key(key),
+        feedback(static_cast<Feedback>((blacks << 4) | whites)),
+        time(static_cast<uint16_t>(time)) {};
+
+  uint blacks() const { return feedbackBlacks(feedback); }
+  uint whites() const { return feedbackWhites(feedback); }
+  std::string serialize() const;
+};
+
+/// Resident state of a game. Fixed size and allocation free, dates are only formatted
+/// when a game is rendered
+class Game {
+ public:
+  enum Status : uint8_t { FIN, ACT };
+
+  time_t tstamp_start = 0;
+  uint32_t plid = 0;
+  Code key = 0;
+  uint16_t playTime = 0;
+  uint16_t usedTime = 0;  // Finished games only, they end at `tstamp_start + usedTime`
+  uint8_t numAttempts = 0;
+  GameMode mode = GameMode::PLAY;
+  Endings ending = Endings::WIN;
+  Status status = Status::ACT;
+  std::array<Attempt, GUESSES_MAX> attempts;
+
+  Game() = default;
+  Game(const uint32_t plid, const Code key, const GameMode mode, const uint playTime,
+       const time_t tstamp_start)
+      : tstamp_start(tstamp_start),
+        plid(plid),
+        key(key),
+        playTime(static_cast<uint16_t>(playTime)),
+        mode(mode) {};
+
+  time_t tstampEnd() const { return tstamp_start + usedTime; }
+  void addAttempt(const Attempt& attempt);
+  void parseGame(std::string_view contents);
+  void parseHeader(std::string_view header);
+  std::string serializeHeader() const;
+};
+
+#endif
@@ -0,0 +1,65 @@
+#include "GameCache.hpp"
+
+/// @brief Returns the memory taken by an entry: the rendered game plus the list node and
+/// index bucket holding it
+size_t GameCache::entrySize(const Entry& entry) {
+  return sizeof(Entry) + entry.rendered.capacity() + 4 * sizeof(void*) +
+         sizeof(std::pair<const uint32_t, std::list<Entry>::iterator>);
+}
+
+/// @brief Looks up the rendered last finished game of a player
+/// @param plid Player ID
+/// @param ref Reference of the player's last finished game
+/// @param played Finished games count of the player
+/// @param rendered Will store the rendered game
+/// @return `false` if not cached (or cached for an older game)
+bool GameCache::get(const uint32_t plid, const GameRef ref, const uint32_t played,
+                    std::string& rendered) {
+  std::lock_guard<std::mutex> lock(cacheMutex);
+
+  auto it = index.find(plid);
+  if (it == index.end() || it->second->ref != ref || it->second->played != played) {
+    misses++;
+    return false;
+  }
+
+  entries.splice(entries.begin(), entries, it->second);
+  rendered = it->second->rendered;
+  hits++;
+  return true;
+}
+
+/// @brief Caches the rendered last finished game of a player, replacing the player's
+/// previous entry and evicting the least recently used ones over the budget
+/// @param plid Player ID
+/// @param ref Reference of the player's last finished game
+/// @param played Finished games count of the player
+/// @param rendered Rendered game
+void GameCache::put(const uint32_t plid, const GameRef ref, const uint32_t played,
+                    const std::string& rendered) {
+  std::lock_guard<std::mutex> lock(cacheMutex);
+
+  auto it = index.find(plid);
+  if (it != index.end()) {
+    // A slower request may come back with an older game than the one cached
+    if (it->second->played > played) return;
+
+    used -= entrySize(*it->second);
+    entries.erase(it->second);
+    index.erase(it);
+  }
+
+  Entry entry{plid, ref, played, rendered};
+  size_t size = entrySize(entry);
+  if (size > budget) return;
+
+  while (used + size > budget) {
+    used -= entrySize(entries.back());
+    index.erase(entries.back().plid);
+    entries.pop_back();
+  }
+
+  entries.push_front(std::move(entry));
+  index[plid] = entries.begin();
+  used += size;
+}
@@ -0,0 +1,49 @@
+#ifndef SERVER_GAME_CACHE_HPP
+#define SERVER_GAME_CACHE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "storage/Storage.hpp"
+
+/// LRU cache of the rendered last finished game of each player, so repeated STR requests
+/// are served without reading storage. Entries are tagged with the game's reference and
+/// the player's finished games count, so a newer game never hits an older one's entry.
+/// The least recently used entries are evicted once the rendered games exceed the
+/// memory budget
+class GameCache {
+ private:
+  struct Entry {
+    uint32_t plid;
+    GameRef ref;
+    uint32_t played;
+    std::string rendered;
+  };
+
+  size_t budget;    // Bytes
+  size_t used = 0;  // Bytes taken by the entries, bookkeeping included
+  std::list<Entry> entries;  // Most recently used first
+  std::unordered_map<uint32_t, std::list<Entry>::iterator> index;
+  std::mutex cacheMutex;
+
+  std::atomic<uint64_t> hits = 0;
+  std::atomic<uint64_t> misses = 0;
+
+  static size_t entrySize(const Entry& entry);
+
+ public:
+  GameCache(const size_t budget) : budget(budget) {};
+
+  bool get(const uint32_t plid, const GameRef ref, const uint32_t played,
+           std::string& rendered);
+  void put(const uint32_t plid, const GameRef ref, const uint32_t played,
+           const std::string& rendered);
+  uint64_t getHits() const { return hits; };
+  uint64_t getMisses() const { return misses; };
+};
+
+#endif
@@ -1,332 +1,489 @@
 #include "GameStore.hpp"
 
 #include <algorithm>
-#include <fstream>
+#include <exception>
+#include <iomanip>
 #include <vector>
 
 #include "../common/constants.hpp"
+#include "../common/scoring.hpp"
 #include "../common/utils.hpp"
 #include "exceptions/GameExceptions.hpp"
 #include "exceptions/ServerExceptions.hpp"
+#include "utils/ChaCha20Rng.hpp"
 
 namespace fs = std::filesystem;
 
-/// @brief Returns the string representation of a GameMode
-/// @param mode  Gamemode
-std::string gameModeToRepr(const GameMode mode) {
-  switch (mode) {
-    case GameMode::PLAY:
-      return "PLAY";
-    case GameMode::DEBUG:
-      return "DEBUG";
-    default:
-      throw InvalidGameModeException();
-  }
-}
-
-/// @brief Returns the GameMode given the char representation
-/// @param c  Gamemode char
-GameMode charToGameMode(const char c) {
-  switch (c) {
-    case 'P':
-      return GameMode::PLAY;
-    case 'D':
-      return GameMode::DEBUG;
-    default:
-      throw InvalidGameModeException();
-  }
-}
-
-/// @brief Returns the string representation of an Ending
-/// @param ending Ending
-std::string endingToRepr(const Endings ending) {
-  switch (ending) {
-    case Endings::LOST:
-      return "LOST";
-    case Endings::WIN:
-      return "WIN";
-    case Endings::QUIT:
-      return "QUIT";
-    case Endings::TIMEOUT:
-      return "TIMEOUT";
-    default:
-      throw InvalidEndingException();
-  }
-}
-
-/// @brief Returns the Ending given the char representation
-/// @param c Ending char
-Endings charToEnding(const char c) {
-  switch (c) {
-    case 'L':
-      return Endings::LOST;
-    case 'W':
-      return Endings::WIN;
-    case 'Q':
-      return Endings::QUIT;
-    case 'T':
-      return Endings::TIMEOUT;
-    default:
-      throw InvalidEndingException();
-  }
-}
-
-/// @brief Attempt object constructor.
-/// @param att Attempt in string format (Ex: T: GROG 4 0 123)
-Attempt::Attempt(const std::string& att) : blacks(0), whites(0), time(0) {
-  std::string prefix;
-  std::istringstream stream(att);
-
-  stream >> prefix;  // "T:"
-  stream >> att_key;
-  stream >> blacks;
-  stream >> whites;
-  stream >> time;
-}
-
-/// @brief Serializes an attempt given its parameters
-/// @param key Attempt key
-/// @param blacks N blacks (On-position pegs)
-/// @param whites N whites (Off-position pegs)
-/// @param time Elapsed time
-/// @return Serialized attempt in string format
-std::string Attempt::create(const std::string& key, const uint blacks, const uint whites,
-                            const time_t time) {
-  std::ostringstream att_ss;
-  att_ss << "T: " << key << ' ' << blacks << ' ' << whites << ' ' << time << '\n';
-
-  return att_ss.str();
-};
-
-/// @brief Parses the header of game file. (Ex: 100001 D RGBY 100 2024-12-16 19:12:36
-/// 1734376356)
-/// @param file Game file
-void Game::parseHeader(std::ifstream& file) {
-  std::string header;
-  std::getline(file, header);
-  std::istringstream stream(header);
-  char mode_char;
-
-  stream >> plid;
-  stream >> mode_char;
-  stream >> key;
-  stream >> playTime;
-  stream >> date_start;
-  stream >> time_start;
-  stream >> tstamp_start;
-
-  mode = charToGameMode(mode_char);
-}
-
-/// @brief Parses all attempts of a given file. Checks for duplicate attempts
-/// @param file Game file
-/// @param key The new attempt's key
-/// @param last_att Will store the last attempt's key according to the file
-/// @param dup Will indicate if the new attempt's key is duplicated
-/// @return The number of stored attempts in the file
-uint Game::parseAttempts(std::ifstream& file, const std::string& key,
-                         std::string& last_att, bool& dup) {
-  std::string attempt_line;
-  uint atts = 0;
-  while (std::getline(file, attempt_line)) {
-    if (attempt_line[0] == 'T') {
-      Attempt attempt(attempt_line);
-      atts++;
-      if (!key.compare(attempt.att_key)) {
-        dup = true;
-      }
-      last_att = attempt.att_key;
-    }
+/// @brief Generates a random secret key from the calling thread's CSPRNG
+/// @return Packed secret key
+Code GameStore::generateKey() {
+  thread_local ChaCha20Rng rng;
+  Code key = 0;
+
+  for (size_t i = 0; i < SECRET_KEY_LEN; ++i) {
+    key = static_cast<Code>(key * VALID_COLORS_LEN + rng.uniform(VALID_COLORS_LEN));
   }
-  return atts;
+
+  return key;
 }
 
-/// @brief Parses an entire Game file
-/// @param file Game file
-void Game::parseGame(std::ifstream& file) {
-  std::string attempt_line;
-  parseHeader(file);
+/// @brief Calculates the score of a won game, saves it and updates the scoreboard and the
+/// player's totals. The shard lock must be held
+/// @param shard Player's shard
+/// @param plid Player ID
+/// @param key Secret key
+/// @param mode Game mode
+/// @param win_tstamp Timestamp of win
+/// @param used_atts N used attempts
+/// @param used_time used time (seconds)
+void GameStore::saveGameScore(Shard& shard, const std::string& plid,
+                              const std::string& key, const GameMode mode,
+                              const time_t& win_tstamp, const int used_atts,
+                              const int used_time) {
+  int score = 701 + ((GUESSES_MAX - used_atts * used_atts) * 100) / GUESSES_MAX +
+              ((PLAY_TIME_MAX - used_time) * 211) / PLAY_TIME_MAX;
 
-  while (std::getline(file, attempt_line)) {
-    if (attempt_line[0] == 'T') {
-      Attempt attempt(attempt_line);
-      attempts.push_back(attempt);
-    } else {
-      std::istringstream end_stream(attempt_line);
-      char mode_char;
+  LeaderboardEntry entry(score, plid, key, used_atts, mode);
+  storage->saveScore(entry, win_tstamp);
+  shard.newScores.push_back(entry);  // Added to the scoreboard by `withPlayer`
+  shard.stats[strToPlid(plid)].addScore(score);
+}
 
-      end_stream >> date_end;
-      end_stream >> time_end;
-      end_stream >> usedTime;
-      end_stream >> mode_char;
+/// @brief Creates the database directory and storage backend and loads the active games
+/// and the scoreboard into memory, from the last snapshot when there is a usable one
+/// @param dir Database directory
+/// @param type Storage backend type
+/// @param durability_mode When writes are flushed to disk
+/// @param cache_budget Memory budget of the finished games cache (bytes)
+/// @param logger Logger the storage reports failed writes to
+GameStore::GameStore(const std::string& dir, const StorageType type,
+                     const DurabilityMode durability_mode, const size_t cache_budget,
+                     Logger& logger)
+    : storageType(type),
+      scoreboard(SCOREBOARD_MAX_ENTRIES),
+      gameCache(cache_budget),
+      expiryWheel(time(nullptr)) {
+  storeDir = fs::current_path() / dir;
+  snapshotPath = storeDir / ("SNAPSHOT." + storageTypeToRepr(type));
 
-      ending = charToEnding(mode_char);
+  fs::create_directory(storeDir);
+
+  storage = createStorage(type, storeDir, logger);
+  activeGames = std::make_unique<ActiveTable>(
+      type == StorageType::MEMORY ? fs::path()
+                                  : storeDir / ("ACTIVE." + storageTypeToRepr(type)));
+
+  std::unordered_map<uint32_t, Game> active_games;
+  std::unordered_map<uint32_t, GameRef> last_finished;
+  std::unordered_map<uint32_t, PlayerStats> stats;
+  if (!restoreSnapshot(active_games, last_finished, stats)) {
+    active_games.clear();
+    last_finished.clear();
+    stats.clear();
+    scoreboard.clear();
+    storage->load(active_games, last_finished, stats, scoreboard);
+    snapshotDue = true;
+  }
+
+  // The table left by a clean shutdown already holds the active games, as long as the
+  // storage was not written to by anyone else since
+  uint64_t table_position, position;
+  if (activeGames->restored(table_position) && storage->position(position) &&
+      position == table_position) {
+    for (uint32_t shard = 0; shard < STORE_SHARDS; ++shard) {
+      for (const Game& game : activeGames->list(shard)) {
+        expiryWheel.schedule(game.plid,
+                             game.tstamp_start + static_cast<time_t>(game.playTime));
+      }
+    }
+  } else {
+    activeGames->discard();
+    for (const auto& [plid, game] : active_games) {
+      expiryWheel.schedule(plid, game.tstamp_start + static_cast<time_t>(game.playTime));
+      activeGames->insert(game);
     }
   }
+
+  // Hand every player over to its shard
+  for (const auto& [plid, ref] : last_finished) {
+    shardOf(plid).lastFinished.emplace(plid, ref);
+  }
+  for (const auto& [plid, totals] : stats) {
+    shardOf(plid).stats.emplace(plid, totals);
+  }
+
+  durability = std::make_unique<Durability>(*storage, durability_mode);
+  scoreCode(0, 0);  // Builds the feedback table before the first TRY
+  expiryThread = std::thread(&GameStore::expiryLoop, this);
+  snapshotThread = std::thread(&GameStore::snapshotLoop, this);
 }
 
-/// @brief Creates a serialized game header
-/// @param plid Player ID
-/// @param playTime Maximum play time
-/// @param mode Gamemode (Play | Debug)
-/// @param cmd_tstamp Timestamp of created game
-/// @param key Secret key
-/// @return The new game's header in string format
-std::string Game::create(const std::string& plid, const uint playTime,
-                         const GameMode mode, const time_t& cmd_tstamp,
-                         const std::string& key) {
-  std::ostringstream header_ss;
+/// @brief GameStore destructor, stops the background threads, takes a last snapshot and
+/// closes the active games table
+GameStore::~GameStore() {
+  {
+    std::lock_guard<std::mutex> lock(stopMutex);
+    isStopping = true;
+  }
+  stopCond.notify_all();
 
-  header_ss << plid << ' ';
-  header_ss << gameModeToRepr(mode)[0] << ' ';
-  header_ss << key << ' ';
-  header_ss << playTime << ' ';
-  formatTimestamp(header_ss, &cmd_tstamp, TSTAMP_DATE_TIME_PRETTY);
-  header_ss << ' ' << cmd_tstamp << '\n';
+  if (expiryThread.joinable()) {
+    expiryThread.join();
+  }
+  if (snapshotThread.joinable()) {
+    snapshotThread.join();
+  }
 
-  return header_ss.str();
-}
+  try {
+    takeSnapshot();
+  } catch (const std::exception&) {
+    // The next startup replays from the previous snapshot instead
+  }
 
-/// @brief Uses /dev/urandom to generate a random secret key
-/// @return Secret key
-std::string GameStore::generateKey() {
-  std::string key(SECRET_KEY_LEN, '\0');
-  size_t valid_chars_len = strlen(VALID_COLORS);
+  try {
+    uint64_t position;
+    storage->sync();
+    if (storage->position(position)) {
+      activeGames->close(position);
+    }
+  } catch (const std::exception&) {
+    // The next startup rebuilds the active games from storage instead
+  }
+}
 
-  std::ifstream urandom("/dev/urandom", std::ios::in | std::ios::binary);
-  if (!urandom.is_open()) {
-    throw DBFilesystemError();
+/// @brief Loads the snapshot of this storage type and replays the storage changes made
+/// after it. A snapshot that can't be used is removed, as the full load that follows may
+/// rewrite the log it points into
+/// @param active_games Will store the active games
+/// @param last_finished Will store the last finished game of each player
+/// @param stats Will store the finished games totals of each player
+/// @return `false` if there is no usable snapshot
+bool GameStore::restoreSnapshot(std::unordered_map<uint32_t, Game>& active_games,
+                                std::unordered_map<uint32_t, GameRef>& last_finished,
+                                std::unordered_map<uint32_t, PlayerStats>& stats) {
+  Snapshot snapshot;
+  if (!readSnapshot(snapshotPath, snapshot) || snapshot.storage != storageType) {
+    fs::remove(snapshotPath);
+    return false;
   }
 
-  urandom.read(&key[0], SECRET_KEY_LEN);
-  if (!urandom) {
-    throw DBFilesystemError();
+  for (const Game& game : snapshot.activeGames) {
+    active_games[game.plid] = game;
+  }
+  for (const auto& [plid, ref] : snapshot.lastFinished) {
+    last_finished[plid] = ref;
+  }
+  for (const auto& [plid, totals] : snapshot.stats) {
+    stats[plid] = totals;
+  }
+  for (const LeaderboardEntry& entry : snapshot.scores) {
+    scoreboard.insert(entry);
   }
 
-  for (size_t i = 0; i < SECRET_KEY_LEN; ++i) {
-    key[i] = VALID_COLORS[static_cast<unsigned char>(key[i]) % valid_chars_len];
+  if (!storage->loadFrom(snapshot.position, active_games, last_finished, stats,
+                         scoreboard)) {
+    fs::remove(snapshotPath);
+    return false;
   }
 
-  urandom.close();
-  return key;
+  snapshotPosition = snapshot.position;
+  return true;
 }
 
-/// @brief Calculates the on-position and off-position pegs of a given attempt
-/// @param key Game secret key
-/// @param att Attempt key
-/// @param whites N Off-position pegs
-/// @param blacks N On-position pegs
-void GameStore::calculateAttempt(const std::string& key, const std::string& att,
-                                 uint& whites, uint& blacks) {
-  const std::string valid_colors = VALID_COLORS;
+/// @brief Snapshot thread, takes a snapshot every `SNAPSHOT_INTERVAL` seconds (and right
+/// away after a full load)
+void GameStore::snapshotLoop() {
+  std::unique_lock<std::mutex> lock(stopMutex);
+
+  while (!isStopping) {
+    if (snapshotDue) {
+      lock.unlock();
+      try {
+        takeSnapshot();
+      } catch (const std::exception&) {
+        // Retried on the next interval
+      }
+      lock.lock();
+    }
 
-  uint key_count[VALID_COLORS_LEN] = {0};
-  uint attempt_count[VALID_COLORS_LEN] = {0};
+    stopCond.wait_for(lock, std::chrono::seconds(SNAPSHOT_INTERVAL));
+    snapshotDue = true;
+  }
+}
 
-  for (size_t i = 0; i < SECRET_KEY_LEN; ++i) {
-    if (key[i] == att[i]) {
-      // Count on-position pegs
-      blacks++;
-    } else {
-      // Increment frequency of off-position colors
-      key_count[valid_colors.find(key[i])]++;
-      attempt_count[valid_colors.find(att[i])]++;
+/// @brief Writes a snapshot of the resident state, unless nothing was logged since the
+/// last one. Every shard lock is only held to read the storage position and mark the
+/// shards, which are then copied one at a time (copy before write, see `Shard`)
+void GameStore::takeSnapshot() {
+  Snapshot snapshot;
+  snapshot.storage = storageType;
+
+  {
+    // With every shard locked no storage write is in flight, so the marked state matches
+    // the storage position exactly
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(STORE_SHARDS);
+    for (Shard& shard : shards) {
+      locks.emplace_back(shard.mutex);
     }
-  }
 
-  // Count off-position pegs
-  for (size_t i = 0; i < valid_colors.size(); i++) {
-    whites += (key_count[i] < attempt_count[i]) ? key_count[i] : attempt_count[i];
+    if (!storage->position(snapshot.position) || snapshot.position == snapshotPosition) {
+      return;
+    }
+
+    for (Shard& shard : shards) {
+      shard.snapshotPending = true;
+    }
+
+    // Only wins change it, under their player's shard lock. Wins still being committed
+    // are already below the storage position, so they are counted as well
+    uint64_t version;
+    snapshot.scores = scoreboard.top(version);
+
+    bool committing = false;
+    for (const Shard& shard : shards) {
+      committing = committing || !shard.committingScores.empty();
+    }
+    if (committing) {
+      Scoreboard merged(SCOREBOARD_MAX_ENTRIES);
+      for (const LeaderboardEntry& entry : snapshot.scores) {
+        merged.insert(entry);
+      }
+      for (const Shard& shard : shards) {
+        for (const auto& [plid, entries] : shard.committingScores) {
+          for (const LeaderboardEntry& entry : entries) merged.insert(entry);
+        }
+      }
+      snapshot.scores = merged.top(version);
+    }
   }
-}
 
-/// @brief Calculates the score of a won game, and saves it to the SCORES directory
-/// @param plid Player ID
-/// @param key Secret key
-/// @param mode Game mode
-/// @param win_tstamp Timestamp of win
-/// @param used_atts N used attempts
-/// @param used_time used time (seconds)
-void GameStore::saveGameScore(const std::string& plid, const std::string& key,
-                              const GameMode mode, const time_t& win_tstamp,
-                              const int used_atts, const int used_time) {
-  std::ostringstream score_fname;
-  std::ostringstream score_header;
+  for (Shard& shard : shards) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.snapshotPending) {
+      copyForSnapshot(shard);
+    }
 
-  int score = 701 + ((GUESSES_MAX - used_atts * used_atts) * 100) / GUESSES_MAX +
-              ((PLAY_TIME_MAX - used_time) * 211) / PLAY_TIME_MAX;
+    snapshot.activeGames.insert(snapshot.activeGames.end(), shard.snapshotActive.begin(),
+                                shard.snapshotActive.end());
+    snapshot.lastFinished.insert(snapshot.lastFinished.end(),
+                                 shard.snapshotLastFinished.begin(),
+                                 shard.snapshotLastFinished.end());
+    snapshot.stats.insert(snapshot.stats.end(), shard.snapshotStats.begin(),
+                          shard.snapshotStats.end());
+    shard.snapshotActive = {};
+    shard.snapshotLastFinished = {};
+    shard.snapshotStats = {};
+  }
+
+  // Startup will skip the log up to the snapshot's position, which must be on disk first
+  storage->sync();
+  writeSnapshot(snapshotPath, snapshot);
+  snapshotPosition = snapshot.position;
+}
 
-  score_fname << score << '_' << plid << '_';
-  formatTimestamp(score_fname, &win_tstamp, TSTAMP_DATE_TIME_PRETTY_);
-  score_fname << ".txt";
+/// @brief Copies a shard's state into its part of the pending snapshot. The shard lock
+/// must be held
+/// @param shard Shard
+void GameStore::copyForSnapshot(Shard& shard) {
+  shard.snapshotActive = activeGames->list(static_cast<uint32_t>(&shard - shards.data()));
+  shard.snapshotLastFinished.assign(shard.lastFinished.begin(), shard.lastFinished.end());
+  shard.snapshotStats.assign(shard.stats.begin(), shard.stats.end());
+  shard.snapshotPending = false;
+}
+
+/// @brief Expiry thread, advances the timing wheel every second and finalizes the games
+/// whose deadline has passed
+void GameStore::expiryLoop() {
+  std::unique_lock<std::mutex> lock(stopMutex);
 
-  score_header << score << ' ' << plid << ' ' << key << ' ';
-  score_header << used_atts << ' ' << gameModeToRepr(mode)[0] << '\n';
+  while (!isStopping) {
+    stopCond.wait_for(lock, std::chrono::seconds(1));
+    if (isStopping) break;
 
-  fs::path score_path = storeDir / "SCORES" / score_fname.str();
-  std::ofstream file(score_path);
-  if (!file.is_open()) {
-    throw DBFilesystemError();
+    lock.unlock();
+    time_t now = time(nullptr);
+    for (const uint32_t plid : expiryWheel.advance(now)) {
+      expireGame(plid, now);
+    }
+    lock.lock();
   }
+}
 
+/// @brief Finalizes a player's game by timeout, if it is still active and past its
+/// deadline. The player may have ended it, or started another, since it was scheduled
+/// @param plid Player ID
+/// @param now Current timestamp
+void GameStore::expireGame(const uint32_t plid, const time_t& now) {
   try {
-    file << score_header.str();
-    file.close();
-  } catch (const std::exception& e) {
-    throw DBFilesystemError();
+    withPlayer(plid, [&](Shard& shard, bool& dirty) {
+      Code key;
+      dirty = checkTimedoutGame(shard, plid, now, &key) == -2;
+      if (dirty) {
+        shard.unreportedTimeouts[plid] = key;
+      }
+      return dirty;
+    });
+  } catch (const std::exception&) {
+    // Still active: retried on the next tick, or inline by the player's next request
+    expiryWheel.schedule(plid, now + 1);
   }
 }
 
-/// @brief Initializes the required directories for the database
-/// @param dir
-GameStore::GameStore(const std::string& dir) {
-  storeDir = fs::current_path() / dir;
-
-  fs::create_directory(storeDir);
-  fs::create_directory(storeDir / "GAMES");
-  fs::create_directory(storeDir / "SCORES");
+/// @brief Returns the shard that owns a given player
+/// @param plid Player ID
+GameStore::Shard& GameStore::shardOf(const uint32_t plid) {
+  return shards[plid % STORE_SHARDS];
 }
 
-/// @brief Checks if a given player already has an open game, and closes it if ended
-/// already
+/// @brief Copies the resident state of a player. The shard lock must be held
+/// @param shard Player's shard
 /// @param plid Player ID
-/// @param cmd_tstamp Command activation timestamp
-/// @param revealed_key If necessary updated this pointer with the secret key
-/// @return `-1`: No active game;   `-2`: Game ended by timeout;    Else: remaining time
-/// to play (seconds)
-int GameStore::checkTimedoutGame(const std::string& plid, const time_t& cmd_tstamp,
-                                 std::string* revealed_key) {
-  std::string game_fname = "GAME_" + plid + ".txt";
-  fs::path game_path = storeDir / "GAMES" / game_fname;
+GameStore::PlayerUndo GameStore::saveUndo(Shard& shard, const uint32_t plid) {
+  PlayerUndo undo;
+  if (const Game* game = activeGames->find(plid)) undo.game = *game;
+
+  auto transcript = shard.transcripts.find(plid);
+  if (transcript != shard.transcripts.end()) undo.transcript = transcript->second;
+  auto last = shard.lastFinished.find(plid);
+  if (last != shard.lastFinished.end()) undo.lastFinished = last->second;
+  auto totals = shard.stats.find(plid);
+  if (totals != shard.stats.end()) undo.stats = totals->second;
+  auto timeout = shard.unreportedTimeouts.find(plid);
+  if (timeout != shard.unreportedTimeouts.end()) undo.unreportedTimeout = timeout->second;
+  return undo;
+}
 
-  if (!fs::exists(game_path)) return -1;
+/// @brief Puts back the resident state of a player copied by `saveUndo`. The shard lock
+/// must be held
+/// @param shard Player's shard
+/// @param plid Player ID
+/// @param undo State to put back
+void GameStore::applyUndo(Shard& shard, const uint32_t plid, const PlayerUndo& undo) {
+  auto restore = [plid](auto& map, const auto& value) {
+    if (value) {
+      map.insert_or_assign(plid, *value);
+    } else {
+      map.erase(plid);
+    }
+  };
 
-  std::ifstream file(game_path);
-  if (!file.is_open()) {
-    throw DBFilesystemError();
+  if (undo.game) {
+    activeGames->insert(*undo.game);
+  } else {
+    activeGames->erase(plid);
   }
+  restore(shard.transcripts, undo.transcript);
+  restore(shard.lastFinished, undo.lastFinished);
+  restore(shard.stats, undo.stats);
+  restore(shard.unreportedTimeouts, undo.unreportedTimeout);
+}
 
-  try {
-    Game game;
-    game.parseHeader(file);
-    file.close();
+/// @brief Runs `op(shard, dirty)` while holding the player's shard lock. If `op` sets
+/// `dirty`, its writes are committed once the lock is released (also when `op` throws),
+/// so other players of the shard don't wait on the disk flush. In the SYNC and GROUP
+/// modes the player's next request waits for the commit, and a failed commit puts the
+/// player's state back as it was before `op`, so no request sees a change that was
+/// answered with an error. Wins only reach the scoreboard once committed
+/// @param plid Player ID
+/// @param op Operation on the player's resident state
+/// @return Whatever `op` returns
+template <typename Op>
+std::invoke_result_t<Op, GameStore::Shard&, bool&> GameStore::withPlayer(
+    const uint32_t plid, Op op) {
+  Shard& shard = shardOf(plid);
+  const bool strict = durability->isStrict();
+  bool dirty = false;
+  PlayerUndo undo;
+  std::exception_ptr op_error;
+  std::invoke_result_t<Op, Shard&, bool&> result{};
+
+  {
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    shard.commitCond.wait(lock, [&shard, plid] { return !shard.committing.count(plid); });
+    if (shard.snapshotPending) {
+      copyForSnapshot(shard);  // Before `op` changes the shard
+    }
+    if (strict) {
+      undo = saveUndo(shard, plid);
+    }
 
-    int remaining_time = static_cast<int>(cmd_tstamp) - game.tstamp_start;
+    try {
+      result = op(shard, dirty);
+    } catch (...) {
+      op_error = std::current_exception();
+    }
 
-    if (remaining_time >= static_cast<int>(game.playTime)) {
-      time_t end_tstamp = cmd_tstamp + static_cast<time_t>(game.playTime);
-      if (revealed_key != nullptr) {
-        *revealed_key = game.key;
+    if (strict && dirty) {
+      shard.committing.insert(plid);
+      shard.committingScores[plid] = std::move(shard.newScores);
+    } else {
+      for (const LeaderboardEntry& entry : shard.newScores) scoreboard.insert(entry);
+    }
+    shard.newScores.clear();
+  }
+
+  if (strict && dirty) {
+    std::exception_ptr commit_error;
+    try {
+      durability->commit(plid);
+    } catch (...) {
+      commit_error = std::current_exception();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      if (commit_error) {
+        if (shard.snapshotPending) {
+          copyForSnapshot(shard);  // The snapshot's position covers the failed writes
+        }
+        applyUndo(shard, plid, undo);
+      } else {
+        for (const LeaderboardEntry& entry : shard.committingScores[plid]) {
+          scoreboard.insert(entry);
+        }
       }
+      shard.committingScores.erase(plid);
+      shard.committing.erase(plid);
+    }
+    shard.commitCond.notify_all();
+
+    if (commit_error) std::rethrow_exception(commit_error);
+  } else if (dirty) {
+    durability->commit(plid);
+  }
+
+  if (op_error) std::rethrow_exception(op_error);
+  return result;
+}
 
-      std::ofstream o_file(game_path, std::ios::app);
-      endGame(plid, Endings::TIMEOUT, end_tstamp, o_file, game.playTime);
-      return -2;
+/// @brief Checks if a given player already has an open game, and closes it if ended
+/// already. Expired games are normally finalized by the expiry thread, this catches the
+/// ones a request reaches first. The shard lock must be held
+/// @param shard Player's shard
+/// @param plid Player ID
+/// @param cmd_tstamp Command activation timestamp
+/// @param revealed_key If necessary updated this pointer with the secret key
+/// @return `-1`: No active game;   `-2`: Game ended by timeout;    Else: remaining time
+/// to play (seconds)
+int GameStore::checkTimedoutGame(Shard& shard, const uint32_t plid,
+                                 const time_t& cmd_tstamp, Code* revealed_key) {
+  const Game* slot = activeGames->find(plid);
+  if (slot == nullptr) return -1;
+
+  const Game& game = *slot;
+  int elapsed_time = static_cast<int>(cmd_tstamp) - game.tstamp_start;
+
+  if (elapsed_time >= static_cast<int>(game.playTime)) {
+    time_t end_tstamp = game.tstamp_start + static_cast<time_t>(game.playTime);
+    if (revealed_key != nullptr) {
+      *revealed_key = game.key;
     }
-    return remaining_time;
-  } catch (const std::exception& e) {
-    throw DBFilesystemError();
+
+    endGame(shard, game, Endings::TIMEOUT, end_tstamp, game.playTime);
+    return -2;
   }
+  return static_cast<int>(game.playTime) - elapsed_time;
 }
 
 /// @brief Creates a new game entry given the arguments
@@ -337,37 +494,36 @@ int GameStore::checkTimedoutGame(const std::string& plid, const time_t& cmd_tsta
 /// @return Returns the secret key. (Used for logging purposes)
 std::string GameStore::createGame(const std::string& plid, const time_t& cmd_tstamp,
                                   const uint playTime, std::string* key) {
-  // Active game exists
-  if (checkTimedoutGame(plid, cmd_tstamp, nullptr) > 0) {
-    throw OngoingGameException();
-  }
-
-  std::string new_key;
-  GameMode mode;
-  if (key == nullptr) {
-    new_key = generateKey();
-    mode = GameMode::PLAY;
-  } else {
-    new_key = *key;
-    mode = GameMode::DEBUG;
-  }
-
-  std::string game_header = Game::create(plid, playTime, mode, cmd_tstamp, new_key);
+  const uint32_t id = strToPlid(plid);
+
+  return withPlayer(id, [&](Shard& shard, bool& dirty) {
+    // Active game exists
+    int remaining = checkTimedoutGame(shard, id, cmd_tstamp, nullptr);
+    dirty = remaining == -2;
+    if (remaining > 0) {
+      throw OngoingGameException();
+    }
 
-  std::string game_fname = "GAME_" + plid + ".txt";
-  std::ofstream file(storeDir / "GAMES" / game_fname, std::ios::trunc);
-  if (!file.is_open()) {
-    throw DBFilesystemError();
-  }
+    Code new_key;
+    GameMode mode;
+    if (key == nullptr) {
+      new_key = generateKey();
+      mode = GameMode::PLAY;
+    } else if (packCode(*key, new_key)) {
+      mode = GameMode::DEBUG;
+    } else {
+      throw InvalidTrialException();
+    }
 
-  try {
-    file << game_header;
-    file.close();
-  } catch (const std::exception& e) {
-    throw DBFilesystemError();
-  }
+    Game game(id, new_key, mode, playTime, cmd_tstamp);
+    storage->createGame(game);
+    activeGames->insert(game);
+    shard.unreportedTimeouts.erase(id);
+    dirty = true;
+    expiryWheel.schedule(id, cmd_tstamp + static_cast<time_t>(playTime));
 
-  return new_key;
+    return unpackCode(new_key);
+  });
 }
 
 /// @brief Quits the game
@@ -375,299 +531,413 @@ std::string GameStore::createGame(const std::string& plid, const time_t& cmd_tst
 /// @param cmd_tstamp Command activation timestamp
 /// @return Revealed secret key
 std::string GameStore::quitGame(const std::string& plid, const time_t& cmd_tstamp) {
-  // No ongoing game
-  if (checkTimedoutGame(plid, cmd_tstamp, nullptr) < 0) {
-    throw UncontextualizedGameException();
-  }
-
-  std::string game_fname = "GAME_" + plid + ".txt";
-  fs::path game_path = storeDir / "GAMES" / game_fname;
-
-  std::ifstream i_file(game_path);
-  if (!i_file.is_open()) {
-    throw DBFilesystemError();
-  }
-
-  Game game;
-  game.parseHeader(i_file);
+  const uint32_t id = strToPlid(plid);
+
+  return withPlayer(id, [&](Shard& shard, bool& dirty) {
+    // No ongoing game
+    int remaining = checkTimedoutGame(shard, id, cmd_tstamp, nullptr);
+    dirty = remaining == -2;
+    if (remaining < 0) {
+      throw UncontextualizedGameException();
+    }
 
-  std::ofstream o_file(game_path, std::ios::app);
-  if (!o_file.is_open()) {
-    throw DBFilesystemError();
-  }
+    const Game& game = *activeGames->find(id);
+    std::string key = unpackCode(game.key);
 
-  endGame(plid, Endings::QUIT, cmd_tstamp, o_file, cmd_tstamp - game.tstamp_start);
+    endGame(shard, game, Endings::QUIT, cmd_tstamp, cmd_tstamp - game.tstamp_start);
+    dirty = true;
 
-  return game.key;
+    return key;
+  });
 }
 
-/// @brief Retrieves the last game (active/finished) and creates a formatted file with all
-/// information about it
+/// @brief Writes the player, status and start lines of a game's formatted file
+/// @param output_ss Output stream
 /// @param plid Player ID
-/// @param cmd_tstamp Command activation timestamp
-/// @param output Output file containing all information about the game
-/// @return Game status (Active | Finished)
-Game::Status GameStore::getLastGame(const std::string& plid, const time_t& cmd_tstamp,
-                                    std::string& output) {
-  Game game;
-  fs::path game_path;
-  std::ostringstream output_ss;
-
-  if (checkTimedoutGame(plid, cmd_tstamp, NULL) < 0) {
-    game_path = storeDir / "GAMES" / plid / findLastFinishedGame(plid);
-    game.status = Game::Status::FIN;
-  } else {
-    game_path = storeDir / "GAMES" / std::string("GAME_" + plid + ".txt");
-    game.status = Game::Status::ACT;
-  }
-
-  std::ifstream file(game_path);
-  if (!file.is_open()) {
-    throw DBFilesystemError();
-  }
-
-  try {
-    game.parseGame(file);
-    file.close();
-  } catch (const std::exception& e) {
-    throw DBFilesystemError();
-  }
-
+/// @param game Active or finished game
+static void renderHeader(std::ostringstream& output_ss, const std::string& plid,
+                         const Game& game) {
   output_ss << "\nPlayer: " << plid << " | Mode: " << gameModeToRepr(game.mode) << '\n';
   output_ss << "Status: ";
 
   if (game.status == Game::Status::ACT) {
     output_ss << "Active | Secret code: ";
     if (game.mode == GameMode::DEBUG) {
-      output_ss << game.key << '\n';
+      output_ss << unpackCode(game.key) << '\n';
     } else {
       output_ss << "????" << '\n';
     }
   } else {
-    output_ss << "Finished | Secret code: " << game.key << '\n';
+    output_ss << "Finished | Secret code: " << unpackCode(game.key) << '\n';
   }
 
-  output_ss << "Game initiated: " << game.date_start << ' ' << game.time_start << ' ';
+  output_ss << "Game initiated: ";
+  formatTimestamp(output_ss, &game.tstamp_start, TSTAMP_DATE_TIME_PRETTY);
+  output_ss << ' ';
   output_ss << "with " << game.playTime << "s to be completed\n";
+}
 
-  if (game.attempts.empty()) {
+/// @brief Writes the attempts count line of a game's formatted file
+/// @param output_ss Output stream
+/// @param num_attempts Attempts made
+static void renderCount(std::ostringstream& output_ss, const uint num_attempts) {
+  if (num_attempts == 0) {
     output_ss << "\n    --- No transactions found ---\n\n";
   } else {
-    output_ss << "\n    --- Transactions found: " << game.attempts.size() << " ---\n\n";
+    output_ss << "\n    --- Transactions found: " << num_attempts << " ---\n\n";
   }
+}
 
-  for (const auto& att : game.attempts) {
-    output_ss << "    Trial: " << att.att_key << " | nB: " << att.blacks
-              << " | nW: " << att.whites;
-    output_ss << " at " << att.time << "s\n";
-  }
+/// @brief Writes the line of an attempt of a game's formatted file
+/// @param output_ss Output stream
+/// @param att Attempt
+static void renderTrial(std::ostringstream& output_ss, const Attempt& att) {
+  output_ss << "    Trial: " << unpackCode(att.key) << " | nB: " << att.blacks()
+            << " | nW: " << att.whites();
+  output_ss << " at " << att.time << "s\n";
+}
 
-  if (game.status == Game::Status::ACT) {
-    output_ss << "\n    --- " << (game.playTime - (cmd_tstamp - game.tstamp_start))
-              << " seconds remaining ---\n";
-  } else {
-    output_ss << "\nGame terminated: " << endingToRepr(game.ending) << " at "
-              << game.date_end << ' ' << game.time_end;
-    output_ss << "\nDuration: " << game.usedTime << " seconds\n";
+/// @brief Writes the formatted file of a finished game, with all information about it.
+/// Active games are served from their transcript
+/// @param output_ss Output stream
+/// @param plid Player ID
+/// @param game Finished game
+static void renderGame(std::ostringstream& output_ss, const std::string& plid,
+                       const Game& game) {
+  renderHeader(output_ss, plid, game);
+  renderCount(output_ss, game.numAttempts);
+
+  for (size_t i = 0; i < game.numAttempts; ++i) {
+    renderTrial(output_ss, game.attempts[i]);
   }
 
-  output = output_ss.str();
-  return game.status;
+  time_t tstamp_end = game.tstampEnd();
+  output_ss << "\nGame terminated: " << endingToRepr(game.ending) << " at ";
+  formatTimestamp(output_ss, &tstamp_end, TSTAMP_DATE_TIME_PRETTY);
+  output_ss << "\nDuration: " << game.usedTime << " seconds\n";
 }
 
-/// @brief Retrieves the TOP N scores from the SCORES dir and creates a formatted
-/// scoreboard
-/// @return Scoreboard output
-std::string GameStore::getScoreboard() {
-  fs::path scores_path = storeDir / "SCORES";
-  std::vector<fs::path> score_paths;
-
+/// @brief Retrieves the last game (active/finished) and creates a formatted file with all
+/// information about it
+/// @param plid Player ID
+/// @param cmd_tstamp Command activation timestamp
+/// @param output Output file containing all information about the game
+/// @return Game status (Active | Finished)
+Game::Status GameStore::getLastGame(const std::string& plid, const time_t& cmd_tstamp,
+                                    std::string& output) {
+  const uint32_t id = strToPlid(plid);
+  Game game;
+  GameRef ref = 0;
+  uint32_t played = 0;
+  Transcript transcript;
+  uint num_attempts = 0;
+  int remaining = 0;
   std::ostringstream output_ss;
-  output_ss << "\n----------------- Mastermind Leaderboard - TOP "
-            << SCOREBOARD_MAX_ENTRIES << " -----------------\n\n";
-  output_ss << "        \tSCORE PLAYER     CODE    NO TRIALS   MODE\n\n";
 
-  try {
-    for (const auto& entry : fs::directory_iterator(scores_path)) {
-      if (!entry.is_regular_file() || entry.path().extension() != ".txt") {
-        continue;
+  // Only the lookup needs the shard lock. Active games are served from their transcript
+  // and finished games are never modified, so they are read (or served from the cache)
+  // after it is released
+  game.status = withPlayer(id, [&](Shard& shard, bool& dirty) {
+    remaining = checkTimedoutGame(shard, id, cmd_tstamp, nullptr);
+    dirty = remaining == -2;
+    if (remaining >= 0) {
+      const Game& active = *activeGames->find(id);
+      auto it = shard.transcripts.find(id);
+      if (it == shard.transcripts.end()) {
+        std::ostringstream header_ss, trials_ss;
+        renderHeader(header_ss, plid, active);
+        for (size_t i = 0; i < active.numAttempts; ++i) {
+          renderTrial(trials_ss, active.attempts[i]);
+        }
+        it = shard.transcripts.emplace(id, Transcript{header_ss.str(), trials_ss.str()})
+                 .first;
       }
-      score_paths.push_back(entry.path());
+
+      transcript = it->second;
+      num_attempts = active.numAttempts;
+      return Game::Status::ACT;
     }
 
-    if (score_paths.empty()) {
-      throw EmptyScoreboardException();
+    auto it = shard.lastFinished.find(id);
+    if (it == shard.lastFinished.end()) {
+      throw NeverPlayedException();
     }
+    ref = it->second;
+    played = shard.stats[id].played();
+    return Game::Status::FIN;
+  });
 
-    // Sorts the files in alphabetical descending order
-    std::sort(score_paths.begin(), score_paths.end(), std::greater<>());
+  if (game.status == Game::Status::ACT) {
+    renderCount(output_ss, num_attempts);
+    std::string count = output_ss.str();
+    std::string footer =
+        "\n    --- " + std::to_string(remaining) + " seconds remaining ---\n";
 
-    for (size_t i = 0; i < score_paths.size() && i < SCOREBOARD_MAX_ENTRIES; ++i) {
-      std::ifstream file(score_paths[i]);
-      LeaderboardEntry entry(file);
-      file.close();
+    output.clear();
+    output.reserve(transcript.header.size() + count.size() + transcript.trials.size() +
+                   footer.size());
+    output.append(transcript.header).append(count).append(transcript.trials);
+    output.append(footer);
+    return Game::Status::ACT;
+  }
 
-      output_ss << "        " << i + 1 << "\t " << entry.score << "  " << entry.plid;
-      output_ss << "     " << entry.key << "        " << entry.used_atts << "       "
-                << gameModeToRepr(entry.mode) << "\n";
-    }
-  } catch (const EmptyScoreboardException& e) {
-    throw EmptyScoreboardException();
-  } catch (const std::exception& e) {
-    throw DBFilesystemError();
+  if (gameCache.get(id, ref, played, output)) {
+    return Game::Status::FIN;
   }
 
-  return output_ss.str();
+  storage->readFinishedGame(id, ref, game);
+  game.status = Game::Status::FIN;
+
+  renderGame(output_ss, plid, game);
+  output = output_ss.str();
+  gameCache.put(id, ref, played, output);
+  return Game::Status::FIN;
 }
 
-/// @brief Registers an attempt to an ongoing game
+/// @brief Looks up a page of the finished games of a player, newest first. The games
+/// themselves are read one at a time with `getFinishedGame`
 /// @param plid Player ID
 /// @param cmd_tstamp Command activation timestamp
-/// @param att Attempt's key
-/// @param trial Trial number
-/// @param blacks Will store the N of on-position pegs
-/// @param whites Will store the N of off-position pegs
-/// @param real_key Will store the game's key
-/// @return The received trial number + 1
-uint GameStore::attempt(const std::string& plid, const time_t& cmd_tstamp,
-                        const std::string& att, const uint trial, uint& blacks,
-                        uint& whites, std::string& real_key) {
-  int err = checkTimedoutGame(plid, cmd_tstamp, &real_key);
-  if (err == -1) {
-    throw UncontextualizedGameException();
-  } else if (err == -2) {
-    throw TimedoutGameException();
-  }
-
-  std::string game_fname = "GAME_" + plid + ".txt";
-  fs::path game_path = storeDir / "GAMES" / game_fname;
+/// @param offset Number of most recent games to skip
+/// @param count Maximum number of games in the page
+/// @param refs Will store the references of the games in the page
+/// @return Number of finished games of the player
+size_t GameStore::getPlayerHistory(const std::string& plid, const time_t& cmd_tstamp,
+                                   const size_t offset, const size_t count,
+                                   std::vector<GameRef>& refs) {
+  const uint32_t id = strToPlid(plid);
+
+  GameRef last = withPlayer(id, [&](Shard& shard, bool& dirty) {
+    // An expired game is finalized first, so it is part of the history
+    dirty = checkTimedoutGame(shard, id, cmd_tstamp, nullptr) == -2;
+
+    auto it = shard.lastFinished.find(id);
+    if (it == shard.lastFinished.end()) {
+      throw NeverPlayedException();
+    }
+    return it->second;
+  });
 
-  std::ifstream i_file(game_path, std::ios::in | std::ios::out);
-  if (!i_file.is_open()) {
-    throw DBFilesystemError();
+  size_t total = 0;
+  if (!storage->history(id, offset, count, refs, total)) {
+    // This backend only keeps the last finished game
+    total = 1;
+    refs.clear();
+    if (offset == 0 && count > 0) refs.push_back(last);
   }
+  return total;
+}
 
-  bool isDup = false;
-  std::string last_att;
-  uint num_attempts = 0;
+/// @brief Creates the formatted file of a finished game of a player
+/// @param plid Player ID
+/// @param ref Finished game reference, from `getPlayerHistory`
+/// @return Output file containing all information about the game
+std::string GameStore::getFinishedGame(const std::string& plid, const GameRef ref) {
   Game game;
+  std::ostringstream output_ss;
 
-  try {
-    game.parseHeader(i_file);
+  storage->readFinishedGame(strToPlid(plid), ref, game);
+  game.status = Game::Status::FIN;
 
-    num_attempts = game.parseAttempts(i_file, att, last_att, isDup);
-    i_file.close();
-  } catch (const std::exception& e) {
-    throw DBFilesystemError();
-  }
+  renderGame(output_ss, plid, game);
+  return output_ss.str();
+}
 
-  if (trial == num_attempts && !att.compare(last_att)) {
-    calculateAttempt(game.key, att, whites, blacks);
-    return num_attempts;  // Client sent the same trial
-  } else if ((trial == num_attempts && att.compare(last_att)) ||
-             trial != num_attempts + 1) {
-    throw InvalidTrialException();
-  } else if (trial == num_attempts + 1 && isDup) {
-    throw DuplicateTrialException();
+/// @brief Creates a formatted scoreboard from the TOP N scores index
+/// @param version Will store the scoreboard version the output was rendered from
+/// @return Scoreboard output
+std::string GameStore::getScoreboard(uint64_t& version) {
+  std::vector<LeaderboardEntry> entries = scoreboard.top(version);
+  if (entries.empty()) {
+    throw EmptyScoreboardException();
   }
 
-  time_t used_time = cmd_tstamp - game.tstamp_start;
-  calculateAttempt(game.key, att, whites, blacks);
-
-  std::ofstream o_file(game_path, std::ios::app);
-
-  try {
-    o_file << Attempt::create(att, blacks, whites, used_time);
-  } catch (const std::exception& e) {
-    throw DBFilesystemError();
-  }
+  std::ostringstream output_ss;
+  output_ss << "\n----------------- Mastermind Leaderboard - TOP "
+            << SCOREBOARD_MAX_ENTRIES << " -----------------\n\n";
+  output_ss << "        \tSCORE PLAYER     CODE    NO TRIALS   MODE\n\n";
 
-  if (num_attempts == GUESSES_MAX - 1 && blacks != SECRET_KEY_LEN) {
-    endGame(plid, Endings::LOST, cmd_tstamp, o_file, used_time);
-    real_key = game.key;
-    throw ExceededMaxTrialsException();
-  } else if (blacks == SECRET_KEY_LEN) {
-    endGame(plid, Endings::WIN, cmd_tstamp, o_file, used_time);
-    saveGameScore(plid, game.key, game.mode, cmd_tstamp, num_attempts + 1, used_time);
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const LeaderboardEntry& entry = entries[i];
+    output_ss << "        " << i + 1 << "\t " << entry.score << "  " << entry.plid;
+    output_ss << "     " << entry.key << "        " << entry.used_atts << "       "
+              << gameModeToRepr(entry.mode) << "\n";
   }
 
-  return ++num_attempts;
+  return output_ss.str();
 }
 
-/// @brief Ends the game with a given reason
+/// @brief Creates a formatted summary of the finished games of a player, from the totals
+/// kept up to date as its games end
 /// @param plid Player ID
-/// @param reason Ending reason (WIN, LOSS, QUIT, TIMEOUT)
-/// @param tstamp Command activation timestamp
-/// @param file Opened target game file
-/// @param used_time Total used time for this game (seconds)
-void GameStore::endGame(const std::string& plid, const Endings reason,
-                        const time_t& tstamp, std::ofstream& file, const int used_time) {
-  std::ostringstream ss;
-  formatTimestamp(ss, &tstamp, TSTAMP_DATE_TIME_PRETTY);
-  ss << ' ' << used_time << ' ' << endingToRepr(reason)[0] << '\n';
+/// @return Player statistics output
+std::string GameStore::getPlayerStats(const std::string& plid) {
+  const uint32_t id = strToPlid(plid);
+
+  PlayerStats totals = withPlayer(id, [&](Shard& shard, bool&) {
+    auto it = shard.stats.find(id);
+    if (it == shard.stats.end()) {
+      throw NeverPlayedException();
+    }
+    return it->second;
+  });
 
-  file << ss.str();
-  file.close();
+  std::ostringstream output_ss;
+  output_ss << "\nPlayer: " << plid << "\n\n";
+  output_ss << "Games played: " << totals.played();
+  output_ss << " (Wins: " << totals.endings[WIN] << " | Losses: " << totals.endings[LOST]
+            << " | Quits: " << totals.endings[QUIT]
+            << " | Timeouts: " << totals.endings[TIMEOUT] << ")\n";
+
+  double avg_attempts =
+      static_cast<double>(totals.attempts) / std::max<uint32_t>(totals.played(), 1);
+  output_ss << "Average attempts: " << std::fixed << std::setprecision(2) << avg_attempts
+            << '\n';
+  output_ss << "Best score: ";
+  if (totals.bestScore < 0) {
+    output_ss << "-\n";
+  } else {
+    output_ss << totals.bestScore << '\n';
+  }
 
-  std::string game_fname = "GAME_" + plid + ".txt";
-  fs::path game_path = storeDir / "GAMES" / game_fname;
+  return output_ss.str();
+}
 
-  std::ostringstream finished_fname;
-  formatTimestamp(finished_fname, &tstamp, TSTAMP_DATE_TIME_);
-  finished_fname << '_' << endingToRepr(reason)[0] << ".txt";
+/// @brief Returns the encoded scoreboard reply, if one was cached since a new score last
+/// entered the TOP N
+/// @param size Will store the size of the scoreboard file in the reply
+/// @return Encoded reply, or `nullptr` if it has to be rendered again
+std::shared_ptr<const std::string> GameStore::getScoreboardReply(size_t& size) {
+  return scoreboard.cachedReply(size);
+}
 
-  fs::path finished_path = storeDir / "GAMES" / plid / finished_fname.str();
+/// @brief Caches the encoded reply of a scoreboard rendered by `getScoreboard`
+/// @param version Scoreboard version the reply was rendered from
+/// @param encoded Encoded reply
+/// @param size Size of the scoreboard file in the reply
+void GameStore::cacheScoreboardReply(const uint64_t version,
+                                     std::shared_ptr<const std::string> encoded,
+                                     const size_t size) {
+  scoreboard.cacheReply(version, std::move(encoded), size);
+}
 
-  try {
-    // Create PLID directory and store the finished game there
-    fs::create_directories(finished_path.parent_path());
+/// @brief Returns the hit and miss counts of the finished games cache
+/// @param hits Will store the number of STR requests served from the cache
+/// @param misses Will store the number of finished games read from storage for STR
+void GameStore::getCacheStats(uint64_t& hits, uint64_t& misses) {
+  hits = gameCache.getHits();
+  misses = gameCache.getMisses();
+}
 
-    fs::rename(game_path, finished_path);
-  } catch (const fs::filesystem_error& e) {
-    throw DBFilesystemError();
-  }
+/// @brief Returns how many storage flushes the durability mode has issued
+uint64_t GameStore::getFlushCount() {
+  return durability->getFlushes();
 }
 
-/// @brief Finds the last finished game of a given player
+/// @brief Registers an attempt to an ongoing game
 /// @param plid Player ID
-/// @return The target game file name
-std::string GameStore::findLastFinishedGame(const std::string& plid) {
-  fs::path dir = storeDir / "GAMES" / plid;
-  std::vector<std::string> filenames;
-
-  if (!fs::exists(dir)) {
-    throw NeverPlayedException();
+/// @param cmd_tstamp Command activation timestamp
+/// @param att Attempt's key
+/// @param trial Trial number
+/// @param blacks Will store the N of on-position pegs
+/// @param whites Will store the N of off-position pegs
+/// @param real_key Will store the game's key
+/// @return The received trial number + 1
+uint GameStore::attempt(const std::string& plid, const time_t& cmd_tstamp,
+                        const std::string& att, const uint trial, uint& blacks,
+                        uint& whites, std::string& real_key) {
+  const uint32_t id = strToPlid(plid);
+  Code att_code;
+  if (!packCode(att, att_code)) {
+    throw InvalidTrialException();
   }
 
-  try {
-    for (const auto& entry : fs::directory_iterator(dir)) {
-      if (entry.is_regular_file() && entry.path().extension() == ".txt") {
-        filenames.push_back(entry.path().filename().string());
+  return withPlayer(id, [&](Shard& shard, bool& dirty) {
+    Code revealed_key;
+    int err = checkTimedoutGame(shard, id, cmd_tstamp, &revealed_key);
+    if (err == -1) {
+      // The game may have timed out in the background
+      auto it = shard.unreportedTimeouts.find(id);
+      if (it == shard.unreportedTimeouts.end()) {
+        throw UncontextualizedGameException();
       }
+      real_key = unpackCode(it->second);
+      shard.unreportedTimeouts.erase(it);
+      throw TimedoutGameException();
+    } else if (err == -2) {
+      dirty = true;
+      real_key = unpackCode(revealed_key);
+      throw TimedoutGameException();
     }
 
-    std::sort(filenames.begin(), filenames.end(), std::greater<>());
-  } catch (const std::exception& e) {
-    throw DBFilesystemError();
-  }
+    Game& game = *activeGames->find(id);
+    uint num_attempts = game.numAttempts;
 
-  if (filenames.empty()) {
-    throw NeverPlayedException();
-  }
+    bool isDup = false;
+    for (size_t i = 0; i < num_attempts; ++i) {
+      if (game.attempts[i].key == att_code) {
+        isDup = true;
+        break;
+      }
+    }
 
-  return filenames[0];
-}
+    bool isResend = num_attempts > 0 && game.attempts[num_attempts - 1].key == att_code;
+
+    if (trial == num_attempts && isResend) {
+      blacks = game.attempts[num_attempts - 1].blacks();
+      whites = game.attempts[num_attempts - 1].whites();
+      return num_attempts;  // Client sent the same trial
+    } else if (trial != num_attempts + 1) {
+      throw InvalidTrialException();
+    } else if (isDup) {
+      throw DuplicateTrialException();
+    }
+
+    time_t used_time = cmd_tstamp - game.tstamp_start;
+    Feedback feedback = scoreCode(game.key, att_code);
+    blacks = feedbackBlacks(feedback);
+    whites = feedbackWhites(feedback);
+
+    Attempt new_att(att_code, blacks, whites, used_time);
+    storage->addAttempt(game, new_att);
+    game.addAttempt(new_att);
+    dirty = true;
+
+    auto it = shard.transcripts.find(id);
+    if (it != shard.transcripts.end()) {
+      std::ostringstream trial_ss;
+      renderTrial(trial_ss, new_att);
+      it->second.trials += trial_ss.str();
+    }
 
-/// @brief Leaderboard entry object constructor
-/// @param file Score file
-LeaderboardEntry::LeaderboardEntry(std::ifstream& file) {
-  char mode_char;
+    if (num_attempts == GUESSES_MAX - 1 && blacks != SECRET_KEY_LEN) {
+      real_key = unpackCode(game.key);
+      endGame(shard, game, Endings::LOST, cmd_tstamp, used_time);
+      throw ExceededMaxTrialsException();
+    } else if (blacks == SECRET_KEY_LEN) {
+      std::string key = unpackCode(game.key);
+      GameMode mode = game.mode;
+      endGame(shard, game, Endings::WIN, cmd_tstamp, used_time);
+      saveGameScore(shard, plid, key, mode, cmd_tstamp, num_attempts + 1, used_time);
+    }
 
-  file >> score;
-  file >> plid;
-  file >> key;
-  file >> used_atts;
-  file >> mode_char;
+    return ++num_attempts;
+  });
+}
 
-  mode = charToGameMode(mode_char);
+/// @brief Ends the game with a given reason, removes it from the active games table,
+/// makes it the player's last finished game and adds it to the player's totals. `game`
+/// must not be used after this call. The shard lock must be held
+/// @param shard Player's shard
+/// @param game Active game being ended
+/// @param reason Ending reason (WIN, LOSS, QUIT, TIMEOUT)
+/// @param tstamp Command activation timestamp
+/// @param used_time Total used time for this game (seconds)
+void GameStore::endGame(Shard& shard, const Game& game, const Endings reason,
+                        const time_t& tstamp, const int used_time) {
+  uint32_t plid = game.plid;
+  shard.lastFinished[plid] = storage->endGame(game, reason, tstamp, used_time);
+  shard.stats[plid].addGame(reason, game.numAttempts);
+  shard.transcripts.erase(plid);
+  activeGames->erase(plid);
 }
@@ -1,86 +1,129 @@
 #ifndef SERVER_GAME_STORE_HPP
 #define SERVER_GAME_STORE_HPP
 
+#include <array>
+#include <condition_variable>
 #include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
-enum GameMode { PLAY, DEBUG };
-enum Endings { WIN, LOST, QUIT, TIMEOUT };
+#include "../common/Logger.hpp"
+#include "../common/constants.hpp"
 
-std::string gameModeToRepr(const GameMode mode);
-GameMode charToGameMode(const char c);
-
-std::string endingToRepr(const Endings ending);
-Endings charToEnding(const char c);
-
-class LeaderboardEntry {
- public:
-  int score;
-  std::string plid;
-  std::string key;
-  uint used_atts;
-  GameMode mode;
-
-  LeaderboardEntry(std::ifstream& file);
-};
-
-class Attempt {
- public:
-  std::string att_key;
-  uint blacks;
-  uint whites;
-  uint time;
-
-  Attempt(const std::string& att);
-  static std::string create(const std::string& key, const uint blacks, const uint whites,
-                            const time_t time);
-};
-
-class Game {
- public:
-  enum Status { FIN, ACT };
-
-  std::string plid;
-  std::string key;
-  std::string date_start;
-  std::string date_end;
-  std::string time_start;
-  std::string time_end;
-
-  std::vector<Attempt> attempts;
-  GameMode mode;
-  Endings ending;
-  Status status;
-  uint playTime;
-  uint usedTime;
-  int tstamp_start;
-
-  void parseGame(std::ifstream& file);
-  void parseHeader(std::ifstream& file);
-  uint parseAttempts(std::ifstream& file, const std::string& key, std::string& last_att,
-                     bool& dup);
-  static std::string create(const std::string& plid, const uint playTime,
-                            const GameMode mode, const time_t& cmd_tstamp,
-                            const std::string& key);
-};
+#include "ActiveTable.hpp"
+#include "Game.hpp"
+#include "GameCache.hpp"
+#include "Scoreboard.hpp"
+#include "storage/Durability.hpp"
+#include "storage/Snapshot.hpp"
+#include "storage/Storage.hpp"
+#include "utils/TimingWheel.hpp"
 
 class GameStore {
  private:
   std::filesystem::path storeDir;
-
-  int checkTimedoutGame(const std::string& plid, const time_t& cmd_tstamp,
-                        std::string* revealed_key);
-  void calculateAttempt(const std::string& key, const std::string& att, uint& whites,
-                        uint& blacks);
-  void saveGameScore(const std::string& plid, const std::string& key, const GameMode mode,
-                     const time_t& win_tstamp, const int used_atts, const int used_time);
-  void endGame(const std::string& plid, const Endings reason, const time_t& tstamp,
-               std::ofstream& file, const int play_time);
-  std::string generateKey();
-  std::string findLastFinishedGame(const std::string& plid);
+  StorageType storageType;
+  std::unique_ptr<Storage> storage;
+  std::unique_ptr<Durability> durability;
+  Scoreboard scoreboard;
+  GameCache gameCache;  // Last finished games rendered for STR
+
+  /// Rendered STR of an active game, built on its first STR and then extended by one
+  /// line per accepted attempt. Only the attempts count and the remaining time are
+  /// rendered on each request
+  struct Transcript {
+    std::string header;  // Player, status and start lines
+    std::string trials;  // One line per attempt
+  };
+
+  // Active games of every player. A player's slot is guarded by the player's shard lock
+  std::unique_ptr<ActiveTable> activeGames;
+
+  /// Players are partitioned by PLID into shards. A shard owns the resident state of its
+  /// players and its mutex serializes every request made on them
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_map<uint32_t, Transcript> transcripts;  // Active games only
+    std::unordered_map<uint32_t, GameRef> lastFinished;
+    std::unordered_map<uint32_t, PlayerStats> stats;
+    // Keys of games expired in the background, until the player's next TRY reports it
+    std::unordered_map<uint32_t, Code> unreportedTimeouts;
+
+    // Players whose last request is waiting on its commit (SYNC and GROUP modes). Their
+    // state may still be rolled back, so their next request waits until it is settled
+    std::unordered_set<uint32_t> committing;
+    std::condition_variable commitCond;
+    std::vector<LeaderboardEntry> newScores;  // Wins of the request holding the lock
+    // Wins of the committing players, only added to the scoreboard once durable
+    std::unordered_map<uint32_t, std::vector<LeaderboardEntry>> committingScores;
+
+    // The shard's part of the snapshot being taken. It is copied by the snapshot thread,
+    // or by the first request on the shard if that comes earlier, so the copy is always
+    // made before the shard changes
+    bool snapshotPending = false;
+    std::vector<Game> snapshotActive;
+    std::vector<std::pair<uint32_t, GameRef>> snapshotLastFinished;
+    std::vector<std::pair<uint32_t, PlayerStats>> snapshotStats;
+  };
+  std::array<Shard, STORE_SHARDS> shards;
+
+  /// A player's resident state before a request, put back if its writes fail to commit
+  struct PlayerUndo {
+    std::optional<Game> game;
+    std::optional<Transcript> transcript;
+    std::optional<GameRef> lastFinished;
+    std::optional<PlayerStats> stats;
+    std::optional<Code> unreportedTimeout;
+  };
+
+  // Finalizes games at their deadline, so requests don't have to
+  TimingWheel expiryWheel;
+  std::thread expiryThread;
+
+  // Periodically saves the resident state, so startup only replays the changes made
+  // after the last snapshot
+  std::filesystem::path snapshotPath;
+  uint64_t snapshotPosition = 0;  // Storage position of the last snapshot written
+  bool snapshotDue = false;
+  std::thread snapshotThread;
+
+  std::mutex stopMutex;
+  std::condition_variable stopCond;
+  bool isStopping = false;
+
+  Shard& shardOf(const uint32_t plid);
+  PlayerUndo saveUndo(Shard& shard, const uint32_t plid);
+  void applyUndo(Shard& shard, const uint32_t plid, const PlayerUndo& undo);
+  template <typename Op>
+  std::invoke_result_t<Op, Shard&, bool&> withPlayer(const uint32_t plid, Op op);
+  int checkTimedoutGame(Shard& shard, const uint32_t plid, const time_t& cmd_tstamp,
+                        Code* revealed_key);
+  void expiryLoop();
+  bool restoreSnapshot(std::unordered_map<uint32_t, Game>& active_games,
+                       std::unordered_map<uint32_t, GameRef>& last_finished,
+                       std::unordered_map<uint32_t, PlayerStats>& stats);
+  void snapshotLoop();
+  void takeSnapshot();
+  void copyForSnapshot(Shard& shard);
+  void expireGame(const uint32_t plid, const time_t& now);
+  void saveGameScore(Shard& shard, const std::string& plid, const std::string& key,
+                     const GameMode mode, const time_t& win_tstamp, const int used_atts,
+                     const int used_time);
+  void endGame(Shard& shard, const Game& game, const Endings reason,
+               const time_t& tstamp, const int used_time);
+  Code generateKey();
 
  public:
-  GameStore(const std::string& dir);
+  GameStore(const std::string& dir, const StorageType type,
+            const DurabilityMode durability_mode, const size_t cache_budget,
+            Logger& logger);
+  ~GameStore();
 
   std::string createGame(const std::string& plid, const time_t& cmd_tstamp,
                          const uint playTime, std::string* key);
@@ -89,7 +132,18 @@ class GameStore {
   std::string quitGame(const std::string& plid, const time_t& cmd_tstamp);
   Game::Status getLastGame(const std::string& plid, const time_t& cmd_tstamp,
                            std::string& output);
-  std::string getScoreboard();
+  size_t getPlayerHistory(const std::string& plid, const time_t& cmd_tstamp,
+                          const size_t offset, const size_t count,
+                          std::vector<GameRef>& refs);
+  std::string getFinishedGame(const std::string& plid, const GameRef ref);
+  std::string getScoreboard(uint64_t& version);
+  std::string getPlayerStats(const std::string& plid);
+  std::shared_ptr<const std::string> getScoreboardReply(size_t& size);
+  void cacheScoreboardReply(const uint64_t version,
+                            std::shared_ptr<const std::string> encoded,
+                            const size_t size);
+  void getCacheStats(uint64_t& hits, uint64_t& misses);
+  uint64_t getFlushCount();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include "Scoreboard.hpp"
+
+#include <algorithm>
+
+/// @brief Inserts a score if it makes it into the top entries
+/// @param entry Score entry
+/// @return Whether the top entries have changed
+bool Scoreboard::insert(const LeaderboardEntry& entry) {
+  std::lock_guard<std::mutex> lock(boardMutex);
+
+  if (entries.size() == capacity && !entry.isBetterThan(entries.back())) {
+    return false;
+  }
+
+  // Ties keep the older entry first
+  auto pos = std::upper_bound(entries.begin(), entries.end(), entry,
+                              [](const LeaderboardEntry& a, const LeaderboardEntry& b) {
+                                return a.isBetterThan(b);
+                              });
+  entries.insert(pos, entry);
+
+  if (entries.size() > capacity) {
+    entries.pop_back();
+  }
+  version++;
+  return true;
+}
+
+/// @brief Returns a copy of the top entries, best first
+/// @param top_version Will store the version of the returned entries
+std::vector<LeaderboardEntry> Scoreboard::top(uint64_t& top_version) {
+  std::lock_guard<std::mutex> lock(boardMutex);
+  top_version = version;
+  return entries;
+}
+
+/// @brief Returns the cached reply if it was rendered from the current top entries
+/// @param size Will store the size of the scoreboard file in the reply
+/// @return Encoded reply, or `nullptr` if there is none or it is stale
+std::shared_ptr<const std::string> Scoreboard::cachedReply(size_t& size) {
+  std::lock_guard<std::mutex> lock(boardMutex);
+  if (reply == nullptr || replyVersion != version) {
+    return nullptr;
+  }
+  size = replySize;
+  return reply;
+}
+
+/// @brief Caches the encoded reply of a rendered scoreboard
+/// @param reply_version Version of the top entries the reply was rendered from
+/// @param encoded Encoded reply
+/// @param size Size of the scoreboard file in the reply
+void Scoreboard::cacheReply(const uint64_t reply_version,
+                            std::shared_ptr<const std::string> encoded, const size_t size) {
+  std::lock_guard<std::mutex> lock(boardMutex);
+  reply = std::move(encoded);
+  replyVersion = reply_version;
+  replySize = size;
+}
+
+/// @brief Removes every entry
+void Scoreboard::clear() {
+  std::lock_guard<std::mutex> lock(boardMutex);
+  entries.clear();
+  version++;
+}
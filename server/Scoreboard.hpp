@@ -0,0 +1,39 @@
+#ifndef SERVER_SCOREBOARD_HPP
+#define SERVER_SCOREBOARD_HPP
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Game.hpp"
+
+/// Bounded top-K index of the best scores. Built once at startup and updated on every
+/// win, so it never has to look at the full score history
+class Scoreboard {
+ private:
+  size_t capacity;
+  std::vector<LeaderboardEntry> entries;  // Best first, at most `capacity` entries
+  uint64_t version = 0;                   // Bumped whenever the top entries change
+  std::mutex boardMutex;
+
+  // Encoded reply rendered from `replyVersion`, stale once `version` moves past it
+  std::shared_ptr<const std::string> reply;
+  uint64_t replyVersion = 0;
+  size_t replySize = 0;
+
+ public:
+  Scoreboard(const size_t capacity) : capacity(capacity) {
+    entries.reserve(capacity + 1);
+  };
+
+  bool insert(const LeaderboardEntry& entry);
+  std::vector<LeaderboardEntry> top(uint64_t& top_version);
+  std::shared_ptr<const std::string> cachedReply(size_t& size);
+  void cacheReply(const uint64_t reply_version, std::shared_ptr<const std::string> encoded,
+                  const size_t size);
+  void clear();
+};
+
+#endif
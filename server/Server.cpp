@@ -17,16 +17,19 @@ Server::Server(Config& config, Logger& logger)
       _udpSocket(_port),
       _tcpSocket(_port),
       logger(logger),
-      store(config.dataPath) {
+      store(config.dataPath, config.storage, config.durability, config.cacheBudget,
+            logger) {
   registerCommands();
 };
 
-/// @brief Calls the socket's setup method and logs the bound address
+/// @brief Calls the socket's setup method, creates the UDP workers threads and logs the
+/// bound address
 void Server::setupUdp() {
   char ipstr[INET_ADDRSTRLEN];
   std::ostringstream log_msg;
 
   _udpSocket.setup();
+  _udpPool.dispatch(UDP_WORKERS);  // Dispatch UDP worker threads
 
   // Log address and port of bound socket
   const addrinfo* info = _udpSocket.getSocketInfo();
@@ -66,6 +69,8 @@ void Server::registerCommands() {
   // TCP commands
   _tcp_handlers.insert({ShowTrialsPacket::packetID, showTrialsHandler});
   _tcp_handlers.insert({ShowScoreboardPacket::packetID, showScoreboardHandler});
+  _tcp_handlers.insert({ShowStatsPacket::packetID, showStatsHandler});
+  _tcp_handlers.insert({ShowHistoryPacket::packetID, showHistoryHandler});
 }
 
 /// @brief Handles an UDP command
@@ -97,17 +102,14 @@ void Server::handleTcpCommand(const std::string& packetId, const int conn_fd,
   it->second(conn_fd, store, logger, replyPacket);
 }
 
-/// @brief Runs the UDP listener loop
+/// @brief Runs the UDP listener loop. Requests are handled by the UDP worker threads, so
+/// requests of different players run in parallel
 void Server::runUdp() {
   while (!terminateFlag.load()) {
     struct sockaddr_in client_addr;
-    std::string response;
-    char client_addrstr[INET_ADDRSTRLEN];
 
     try {
-      std::unique_ptr<UdpPacket> replyPacket = nullptr;
       std::stringstream packetStream;
-      packetStream >> std::noskipws;
 
       // Receive packet from client
       int rec = _udpSocket.receivePacket(packetStream, client_addr);
@@ -118,56 +120,80 @@ void Server::runUdp() {
 
       // Get client address and port
       const addrinfo* info = _udpSocket.getSocketInfo();
+      char client_addrstr[INET_ADDRSTRLEN];
       inet_ntop(info->ai_family, &client_addr.sin_addr, client_addrstr,
                 sizeof(client_addrstr));
 
-      // Log request (verbose)
-      std::ostringstream log_msg;
+      // Handle request with worker thread
       std::string packetStr = packetStream.str();
-      log_msg << "(UDP) " << "[" << client_addrstr << ":" << ntohs(client_addr.sin_port)
-              << "] > ";
-      log_msg << '\"' << packetStr << '\"';
-      logger.logVerbose(Logger::Severity::INFO, log_msg.str(), true);
-
-      // Get packet ID
-      UdpParser parser(packetStream);
-      std::string packetID = parser.parsePacketID();
-
-      // Dispatch command
-      handleUdpCommand(packetID, packetStream, replyPacket);
-
-      // Send reply
-      if (replyPacket != nullptr)
-        response = _udpSocket.sendPacket(replyPacket, client_addr);
-    } catch (const CommonException& e) {
-      logger.log(Logger::Severity::WARN, e.what(), true);
-      try {
-        std::unique_ptr<UdpPacket> errPacket = std::make_unique<UdpErrorPacket>();
-        response = _udpSocket.sendPacket(errPacket, client_addr);
-      } catch (const ServerSendError& e) {
-        logger.log(Logger::Severity::ERROR, e.what(), true);
-      }
+      _udpPool.enqueueConnection([this, packetStr, client_addr, client_addrstr] {
+        handleUdpRequest(packetStr, client_addr, client_addrstr);
+      });
     } catch (const CommonError& e) {
-      logger.log(Logger::Severity::WARN, e.what(), true);
-      try {
-        std::unique_ptr<UdpPacket> errPacket = std::make_unique<UdpErrorPacket>();
-        response = _udpSocket.sendPacket(errPacket, client_addr);
-      } catch (const ServerSendError& e) {
-        logger.log(Logger::Severity::ERROR, e.what(), true);
-      }
-    } catch (const std::exception& e) {
       logger.log(Logger::Severity::ERROR, e.what(), true);
     }
+  }
+  logger.log(Logger::Severity::INFO, "UDP monitor terminated! Closing worker threads...",
+             true);
+}
 
-    // Log response (verbose)
-    if (!response.empty()) {
-      std::ostringstream log_msg;
-      log_msg << "(UDP) " << '\"' << response << '\"';
-      log_msg << " > [" << client_addrstr << ":" << ntohs(client_addr.sin_port) << ']';
-      logger.logVerbose(Logger::Severity::INFO, log_msg.str(), true);
+/// @brief Ran by a worker thread, handles an UDP request
+/// @param packetStr The received packet
+/// @param client_addr Client's address information
+/// @param client_addrstr Client's IP address (string format XXX.XXX.XXX.XXX)
+void Server::handleUdpRequest(const std::string& packetStr, sockaddr_in client_addr,
+                              const char* client_addrstr) {
+  std::string response;
+
+  try {
+    std::unique_ptr<UdpPacket> replyPacket = nullptr;
+    std::stringstream packetStream(packetStr);
+    packetStream >> std::noskipws;
+
+    // Log request (verbose)
+    std::ostringstream log_msg;
+    log_msg << "(UDP) " << "[" << client_addrstr << ":" << ntohs(client_addr.sin_port)
+            << "] > ";
+    log_msg << '\"' << packetStr << '\"';
+    logger.logVerbose(Logger::Severity::INFO, log_msg.str(), true);
+
+    // Get packet ID
+    UdpParser parser(packetStream);
+    std::string packetID = parser.parsePacketID();
+
+    // Dispatch command
+    handleUdpCommand(packetID, packetStream, replyPacket);
+
+    // Send reply
+    if (replyPacket != nullptr)
+      response = _udpSocket.sendPacket(replyPacket, client_addr);
+  } catch (const CommonException& e) {
+    logger.log(Logger::Severity::WARN, e.what(), true);
+    try {
+      std::unique_ptr<UdpPacket> errPacket = std::make_unique<UdpErrorPacket>();
+      response = _udpSocket.sendPacket(errPacket, client_addr);
+    } catch (const ServerSendError& e) {
+      logger.log(Logger::Severity::ERROR, e.what(), true);
+    }
+  } catch (const CommonError& e) {
+    logger.log(Logger::Severity::WARN, e.what(), true);
+    try {
+      std::unique_ptr<UdpPacket> errPacket = std::make_unique<UdpErrorPacket>();
+      response = _udpSocket.sendPacket(errPacket, client_addr);
+    } catch (const ServerSendError& e) {
+      logger.log(Logger::Severity::ERROR, e.what(), true);
     }
+  } catch (const std::exception& e) {
+    logger.log(Logger::Severity::ERROR, e.what(), true);
+  }
+
+  // Log response (verbose)
+  if (!response.empty()) {
+    std::ostringstream log_msg;
+    log_msg << "(UDP) " << '\"' << response << '\"';
+    log_msg << " > [" << client_addrstr << ":" << ntohs(client_addr.sin_port) << ']';
+    logger.logVerbose(Logger::Severity::INFO, log_msg.str(), true);
   }
-  logger.log(Logger::Severity::INFO, "UDP monitor terminated!", true);
 }
 
 /// @brief Runs the TCP listener loop
@@ -207,6 +233,12 @@ void Server::runTcp() {
   }
   logger.log(Logger::Severity::INFO, "TCP monitor terminated! Closing worker threads...",
              true);
+
+  uint64_t hits, misses;
+  std::ostringstream log_msg;
+  store.getCacheStats(hits, misses);
+  log_msg << "STR cache: " << hits << " hits, " << misses << " misses";
+  logger.log(Logger::Severity::INFO, log_msg.str(), true);
 }
 
 /// @brief Ran by a worker thread, handles a TCP connection
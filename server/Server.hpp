@@ -24,7 +24,6 @@ class Server {
   TcpSocket _tcpSocket;
   std::unordered_map<std::string, HandlerUdpFunc> _udp_handlers;
   std::unordered_map<std::string, HandlerTcpFunc> _tcp_handlers;
-  WorkerPool _tcpPool;
 
   void registerCommands();
   void handleUdpCommand(const std::string& packetId, std::stringstream& packetStream,
@@ -41,8 +40,15 @@ class Server {
   void setupTcp();
   void runUdp();
   void runTcp();
+  void handleUdpRequest(const std::string& packetStr, sockaddr_in client_addr,
+                        const char* client_addrstr);
   void handleTcpConnection(const int conn_fd, const char* client_addrstr,
                            const sockaddr_in& client_addr);
+
+ private:
+  // Declared after the store so the workers are joined before it is destroyed
+  WorkerPool _udpPool;
+  WorkerPool _tcpPool;
 };
 
 #endif
\ No newline at end of file
@@ -64,16 +64,31 @@ void showScoreboardHandler(const int fd, GameStore& store, Logger& logger,
   try {
     request.read(fd);
 
-    std::string file_str = store.getScoreboard();
+    size_t fsize = 0;
+    std::shared_ptr<const std::string> encoded = store.getScoreboardReply(fsize);
 
-    reply->fname = "TOPSCORES.txt";
-    reply->fsize = file_str.size();
-    reply->fdata = file_str + '\n';
-    reply->status = ReplyShowScoreboardPacket::OK;
+    // Scoreboard changed since the cached reply was encoded
+    if (encoded == nullptr) {
+      uint64_t version;
+      std::string file_str = store.getScoreboard(version);
+
+      reply->fname = "TOPSCORES.txt";
+      reply->fsize = file_str.size();
+      reply->fdata = file_str + '\n';
+      reply->status = ReplyShowScoreboardPacket::OK;
+
+      encoded = std::make_shared<const std::string>(reply->encode());
+      fsize = reply->fsize;
+
+      store.cacheScoreboardReply(version, encoded, fsize);
+    }
 
     std::stringstream ss;
-    ss << "Sending scoreboard... (" << reply->fsize << " Bytes)";
+    ss << "Sending scoreboard... (" << fsize << " Bytes)";
     logger.log(Logger::Severity::INFO, ss.str(), true);
+
+    replyPacket = std::make_unique<EncodedTcpPacket>(encoded);
+    return;
   } catch (const EmptyScoreboardException& e) {
     reply->status = ReplyShowScoreboardPacket::EMPTY;  // Scoreboard is empty
     logger.log(Logger::Severity::WARN, e.what(), true);
@@ -84,4 +99,87 @@ void showScoreboardHandler(const int fd, GameStore& store, Logger& logger,
   }
 
   replyPacket = std::move(reply);
-}
\ No newline at end of file
+}
+
+/// @brief Show stats handler. Provides the totals of the finished games of a player
+/// @param fd TCP connection descriptor
+/// @param store GameStore object responsible for managing the database
+/// @param logger Logger object for logging useful information
+/// @param replyPacket Will store the reply packet to be sent later
+void showStatsHandler(const int fd, GameStore& store, Logger& logger,
+                      std::unique_ptr<TcpPacket>& replyPacket) {
+  ShowStatsPacket request;
+  auto reply = std::make_unique<ReplyShowStatsPacket>();
+  reply->status = ReplyShowStatsPacket::NOK;
+
+  try {
+    request.read(fd);
+
+    std::string file_str = store.getPlayerStats(request.playerID);
+
+    reply->status = ReplyShowStatsPacket::OK;
+    reply->fname = "STATS_" + request.playerID + ".txt";
+    reply->fsize = file_str.size();
+    reply->fdata = file_str + '\n';
+
+    std::stringstream ss;
+    ss << "[Player " << request.playerID << "] > Requested stats. (" << reply->fsize
+       << " Bytes)";
+    logger.log(Logger::Severity::INFO, ss.str(), true);
+  } catch (const std::exception& e) {
+    reply->status = ReplyShowStatsPacket::NOK;  // Never played or some other error
+    logger.log(Logger::Severity::WARN, e.what(), true);
+  }
+
+  replyPacket = std::move(reply);
+}
+
+/// @brief Show history handler. Provides a page of the finished games of a player, newest
+/// first. Games are read one at a time while the reply is sent
+/// @param fd TCP connection descriptor
+/// @param store GameStore object responsible for managing the database
+/// @param logger Logger object for logging useful information
+/// @param replyPacket Will store the reply packet to be sent later
+void showHistoryHandler(const int fd, GameStore& store, Logger& logger,
+                        std::unique_ptr<TcpPacket>& replyPacket) {
+  ShowHistoryPacket request;
+  auto reply = std::make_unique<ReplyShowHistoryPacket>();
+  reply->status = ReplyShowHistoryPacket::NOK;
+
+  try {
+    time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    request.read(fd);
+
+    std::vector<GameRef> refs;
+    reply->total = store.getPlayerHistory(request.playerID, now, request.offset,
+                                          request.count, refs);
+    reply->status = ReplyShowHistoryPacket::OK;
+    reply->fname = "HISTORY_" + request.playerID + ".txt";
+
+    std::stringstream ss;
+    ss << "[Player " << request.playerID << "] > Requested " << refs.size()
+       << " finished games from " << request.offset << " of " << reply->total;
+    logger.log(Logger::Severity::INFO, ss.str(), true);
+
+    // The header is already sent when a game is read, so a game that can't be read ends
+    // the page early with the usual terminator instead of cutting the connection
+    reply->nextGame = [&store, &logger, plid = request.playerID, refs = std::move(refs),
+                       next = size_t(0)](std::string& fdata) mutable {
+      if (next == refs.size()) return false;
+
+      try {
+        fdata = store.getFinishedGame(plid, refs[next++]);
+      } catch (const std::exception& e) {
+        logger.log(Logger::Severity::WARN, e.what(), true);
+        next = refs.size();
+        return false;
+      }
+      return true;
+    };
+  } catch (const std::exception& e) {
+    reply->status = ReplyShowHistoryPacket::NOK;  // Never played or some other error
+    logger.log(Logger::Severity::WARN, e.what(), true);
+  }
+
+  replyPacket = std::move(reply);
+}
@@ -11,4 +11,10 @@ void showTrialsHandler(const int fd, GameStore& store, Logger& logger,
 void showScoreboardHandler(const int fd, GameStore& store, Logger& logger,
                            std::unique_ptr<TcpPacket>& replyPacket);
 
+void showStatsHandler(const int fd, GameStore& store, Logger& logger,
+                      std::unique_ptr<TcpPacket>& replyPacket);
+
+void showHistoryHandler(const int fd, GameStore& store, Logger& logger,
+                        std::unique_ptr<TcpPacket>& replyPacket);
+
 #endif
\ No newline at end of file
@@ -27,6 +27,14 @@ class InvalidEndingException : public CommonException {
   InvalidEndingException() : CommonException(errorMsg) {};
 };
 
+class InvalidGameFileException : public CommonException {
+ private:
+  const std::string errorMsg = "A stored game could not be parsed";
+
+ public:
+  InvalidGameFileException() : CommonException(errorMsg) {};
+};
+
 class UncontextualizedGameException : public CommonException {
  private:
   const std::string errorMsg = "This player has no ongoing game!";
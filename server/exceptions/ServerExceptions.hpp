@@ -45,4 +45,12 @@ class DBFilesystemError : public CommonError {
   DBFilesystemError() : CommonError(std::string(errorMsg)) {};
 };
 
+class RandomSourceError : public CommonError {
+ private:
+  static constexpr const char* errorMsg = "Failed to read random bytes from the kernel! ";
+
+ public:
+  RandomSourceError() : CommonError(std::string(errorMsg) + std::strerror(errno)) {};
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,183 @@
+#include "Archive.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+
+#include "../exceptions/ServerExceptions.hpp"
+#include "../utils/MappedFile.hpp"
+#include "../utils/scan.hpp"
+
+namespace fs = std::filesystem;
+
+/// @brief Writes a whole buffer to a file descriptor and flushes it
+/// @return `false` on failure
+static bool writeAndSync(const int fd, const std::string& buffer) {
+  size_t written = 0;
+  while (written < buffer.size()) {
+    ssize_t wr = write(fd, buffer.data() + written, buffer.size() - written);
+    if (wr < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    written += static_cast<size_t>(wr);
+  }
+  return fdatasync(fd) == 0;
+}
+
+/// @brief Appends finished games to a player's archive. The data is durable before the
+/// index lines pointing to it are written, and these are durable when this returns, so
+/// the loose files can then be removed
+/// @param dir Player directory
+/// @param games Games to archive
+/// @param appended Will store the locations of the archived games
+void appendToArchive(const fs::path& dir, const std::vector<ArchivedGame>& games,
+                     ArchiveIndex& appended) {
+  fs::path data_path = dir / ARCHIVE_DATA_NAME;
+  fs::path index_path = dir / ARCHIVE_INDEX_NAME;
+  bool created = !fs::exists(index_path);
+
+  int data_fd = open(data_path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+  if (data_fd == -1) {
+    throw DBFilesystemError();
+  }
+
+  // Bytes left behind by an interrupted append are skipped, never referenced
+  struct stat st;
+  if (fstat(data_fd, &st) == -1) {
+    close(data_fd);
+    throw DBFilesystemError();
+  }
+
+  std::string data;
+  std::ostringstream index_ss;
+  uint64_t offset = static_cast<uint64_t>(st.st_size);
+  for (const auto& [name, contents] : games) {
+    data += contents;
+    index_ss << name << ' ' << offset << ' ' << contents.size() << '\n';
+    appended[name] = ArchiveEntry{offset, contents.size()};
+    offset += contents.size();
+  }
+
+  bool ok = writeAndSync(data_fd, data);
+  close(data_fd);
+  if (!ok) {
+    throw DBFilesystemError();
+  }
+
+  int index_fd = open(index_path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+  if (index_fd == -1) {
+    throw DBFilesystemError();
+  }
+
+  // An interrupted append may have left a partial last line
+  std::string lines = index_ss.str();
+  char last = '\n';
+  off_t size = lseek(index_fd, 0, SEEK_END);
+  if (size > 0 && pread(index_fd, &last, 1, size - 1) == 1 && last != '\n') {
+    lines.insert(lines.begin(), '\n');
+  }
+
+  ok = writeAndSync(index_fd, lines);
+  close(index_fd);
+
+  if (ok && created) {
+    int dir_fd = open(dir.c_str(), O_RDONLY);
+    ok = dir_fd != -1 && fsync(dir_fd) == 0;
+    if (dir_fd != -1) close(dir_fd);
+  }
+  if (!ok) {
+    throw DBFilesystemError();
+  }
+}
+
+/// @brief Loads the index of a player's archive. A game archived again after an
+/// interrupted append resolves to its last copy
+/// @param dir Player directory
+/// @param index Will store the locations of the archived games
+/// @return `false` if the player has no archive
+bool loadArchiveIndex(const fs::path& dir, ArchiveIndex& index) {
+  std::string file;
+  if (!readSmallFile(dir / ARCHIVE_INDEX_NAME, file)) {
+    return false;
+  }
+
+  // An unterminated last line is an interrupted append
+  std::string_view contents = std::string_view(file).substr(0, file.rfind('\n') + 1);
+  std::string_view line;
+  while (nextLine(contents, line)) {
+    std::string_view name;
+    ArchiveEntry entry;
+    if (nextToken(line, name) && nextNumber(line, entry.offset) &&
+        nextNumber(line, entry.length)) {
+      index[std::string(name)] = entry;
+    }
+  }
+  return true;
+}
+
+/// @brief Reads an archived game
+/// @param dir Player directory
+/// @param entry Location of the game in the archive
+/// @param contents Will store the game file contents
+void readFromArchive(const fs::path& dir, const ArchiveEntry& entry,
+                     std::string& contents) {
+  int fd = open((dir / ARCHIVE_DATA_NAME).c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    throw DBFilesystemError();
+  }
+
+  contents.assign(entry.length, '\0');
+  ssize_t rd = pread(fd, contents.data(), entry.length, static_cast<off_t>(entry.offset));
+  close(fd);
+  if (rd != static_cast<ssize_t>(entry.length)) {
+    throw DBFilesystemError();
+  }
+}
+
+/// @brief Returns the file names of every archived game of a player, in archiving order
+/// @param dir Player directory
+std::vector<std::string> listArchive(const fs::path& dir) {
+  std::vector<std::string> names;
+  std::ifstream index(dir / ARCHIVE_INDEX_NAME);
+  std::string line;
+
+  while (std::getline(index, line)) {
+    std::istringstream line_ss(line);
+    std::string name;
+    uint64_t offset;
+    uint64_t length;
+    if (line_ss >> name >> offset >> length) {
+      names.push_back(name);
+    }
+  }
+  return names;
+}
+
+/// @brief Reads every archived game of a player, in archiving order
+/// @param dir Player directory
+std::vector<ArchivedGame> readArchive(const fs::path& dir) {
+  std::vector<ArchivedGame> games;
+  std::ifstream index(dir / ARCHIVE_INDEX_NAME);
+  std::ifstream data(dir / ARCHIVE_DATA_NAME, std::ios::binary);
+  std::string line;
+
+  while (std::getline(index, line)) {
+    std::istringstream line_ss(line);
+    std::string name;
+    uint64_t offset;
+    uint64_t length;
+    if (!(line_ss >> name >> offset >> length)) continue;
+
+    std::string contents(length, '\0');
+    if (!data.seekg(static_cast<std::streamoff>(offset)) ||
+        !data.read(contents.data(), static_cast<std::streamsize>(length))) {
+      throw DBFilesystemError();
+    }
+    games.emplace_back(name, contents);
+  }
+  return games;
+}
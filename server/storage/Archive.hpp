@@ -0,0 +1,37 @@
+#ifndef SERVER_ARCHIVE_HPP
+#define SERVER_ARCHIVE_HPP
+
+#include <filesystem>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#define ARCHIVE_DATA_NAME "ARCHIVE.dat"
+#define ARCHIVE_INDEX_NAME "ARCHIVE.idx"
+
+typedef std::pair<std::string, std::string> ArchivedGame;  // File name, contents
+
+/// Location of an archived game in `ARCHIVE.dat`
+struct ArchiveEntry {
+  uint64_t offset;
+  uint64_t length;
+};
+
+/// Locations of a player's archived games, by the file name they had
+typedef std::unordered_map<std::string, ArchiveEntry> ArchiveIndex;
+
+/// Archive of the finished games of a player, kept in its `GAMES/<plid>/` directory.
+/// `ARCHIVE.dat` holds the games back to back, cold encoded (see ColdGame.hpp), and
+/// `ARCHIVE.idx` has one `<file name> <offset> <length>` line per game. Both files are
+/// append-only and only the compactor writes to them
+void appendToArchive(const std::filesystem::path& dir,
+                     const std::vector<ArchivedGame>& games, ArchiveIndex& appended);
+bool loadArchiveIndex(const std::filesystem::path& dir, ArchiveIndex& index);
+void readFromArchive(const std::filesystem::path& dir, const ArchiveEntry& entry,
+                     std::string& contents);
+std::vector<std::string> listArchive(const std::filesystem::path& dir);
+std::vector<ArchivedGame> readArchive(const std::filesystem::path& dir);
+
+#endif
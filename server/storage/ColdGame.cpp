@@ -0,0 +1,109 @@
+#include "ColdGame.hpp"
+
+#include <cstdint>
+
+/// @brief Appends an unsigned LEB128 varint
+static void putVarint(std::string& out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+/// @brief Reads an unsigned LEB128 varint
+/// @param data Encoded data
+/// @param pos Read position, advanced past the varint
+/// @param value Will store the value
+/// @return `false` if the data ends before the varint does
+static bool getVarint(const std::string& data, size_t& pos, uint64_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 64 && pos < data.size(); shift += 7) {
+    uint8_t byte = static_cast<uint8_t>(data[pos++]);
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) return true;
+  }
+  return false;
+}
+
+/// @brief Maps signed values to unsigned ones, keeping small magnitudes small
+static uint64_t zigzag(const int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+static int64_t unzigzag(const uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+/// @brief Encodes a finished game
+/// @param game Finished game
+/// @return Encoded game, starting with `COLD_GAME_TAG`
+std::string encodeColdGame(const Game& game) {
+  std::string out;
+  out.reserve(16 + game.numAttempts * 4);
+
+  out.push_back(COLD_GAME_TAG);
+  putVarint(out, game.plid);
+  putVarint(out, zigzag(game.tstamp_start));
+  putVarint(out, (static_cast<uint64_t>(game.key) << 10) | game.playTime);
+  putVarint(out, game.usedTime);
+  out.push_back(
+      static_cast<char>(game.mode | (game.ending << 1) | (game.numAttempts << 4)));
+
+  uint16_t prev_time = 0;
+  for (size_t i = 0; i < game.numAttempts; ++i) {
+    const Attempt& att = game.attempts[i];
+    putVarint(out, (static_cast<uint64_t>(att.key) << 6) | (att.blacks() << 3) |
+                       att.whites());
+    putVarint(out, zigzag(static_cast<int64_t>(att.time) - prev_time));
+    prev_time = att.time;
+  }
+
+  return out;
+}
+
+/// @brief Decodes a finished game
+/// @param data Encoded game
+/// @param game Will store the finished game
+/// @return `false` if the data is not a valid encoded game
+bool decodeColdGame(const std::string& data, Game& game) {
+  if (!isColdGame(data)) return false;
+
+  size_t pos = 1;
+  uint64_t plid, tstamp_start, key_time, used_time;
+  if (!getVarint(data, pos, plid) || !getVarint(data, pos, tstamp_start) ||
+      !getVarint(data, pos, key_time) || !getVarint(data, pos, used_time) ||
+      pos >= data.size()) {
+    return false;
+  }
+
+  uint8_t flags = static_cast<uint8_t>(data[pos++]);
+  uint num_attempts = flags >> 4;
+  if (num_attempts > GUESSES_MAX) return false;
+
+  game = Game(static_cast<uint32_t>(plid), static_cast<Code>(key_time >> 10),
+              static_cast<GameMode>(flags & 0x1), key_time & 0x3ff,
+              static_cast<time_t>(unzigzag(tstamp_start)));
+  game.usedTime = static_cast<uint16_t>(used_time);
+  game.ending = static_cast<Endings>((flags >> 1) & 0x7);
+  game.status = Game::Status::FIN;
+
+  int64_t time = 0;
+  for (uint i = 0; i < num_attempts; ++i) {
+    uint64_t att, delta;
+    if (!getVarint(data, pos, att) || !getVarint(data, pos, delta)) {
+      return false;
+    }
+
+    time += unzigzag(delta);
+    game.addAttempt(Attempt(static_cast<Code>(att >> 6), (att >> 3) & 0x7, att & 0x7,
+                            static_cast<uint>(time)));
+  }
+
+  return pos == data.size();
+}
+
+/// @brief Checks whether archived data holds an encoded game rather than a game file
+bool isColdGame(const std::string& data) {
+  return !data.empty() && data[0] == COLD_GAME_TAG;
+}
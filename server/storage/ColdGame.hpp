@@ -0,0 +1,17 @@
+#ifndef SERVER_COLD_GAME_HPP
+#define SERVER_COLD_GAME_HPP
+
+#include <string>
+
+#include "../Game.hpp"
+
+#define COLD_GAME_TAG '\xc1'  // Never the first byte of a game file (a PLID digit)
+
+/// Compact encoding of finished games, used once they are archived. Fields are varints,
+/// codes are bit-packed with their feedback and attempt times are stored as deltas, so a
+/// game takes about a fifth of its text file
+std::string encodeColdGame(const Game& game);
+bool decodeColdGame(const std::string& data, Game& game);
+bool isColdGame(const std::string& data);
+
+#endif
@@ -0,0 +1,90 @@
+#include "Durability.hpp"
+
+
+#include "../../common/exceptions/ConfigExceptions.hpp"
+#include "../exceptions/ServerExceptions.hpp"
+
+/// @brief Returns the DurabilityMode given its name
+/// @param str Durability mode name (none | sync | group)
+DurabilityMode strToDurabilityMode(const std::string& str) {
+  if (str == "none") {
+    return DurabilityMode::NONE;
+  } else if (str == "sync") {
+    return DurabilityMode::SYNC;
+  } else if (str == "group") {
+    return DurabilityMode::GROUP;
+  }
+  throw InvalidDurabilityException();
+}
+
+/// @brief Durability policy constructor. A storage that persists nothing has nothing to
+/// flush, so its commits never wait
+/// @param storage Storage backend to be flushed
+/// @param mode Durability mode
+Durability::Durability(Storage& storage, const DurabilityMode mode)
+    : storage(storage), mode(storage.persists() ? mode : DurabilityMode::NONE) {}
+
+/// @brief Flushes every operation committed so far on behalf of the group (the caller
+/// leads the flush), then wakes the operations it covered. The commit lock must be held
+/// @param lock Commit lock, released while flushing
+void Durability::flushGroup(std::unique_lock<std::mutex>& lock) {
+  isFlushing = true;
+  uint64_t target = committedSeq;
+  lock.unlock();
+
+  bool ok = true;
+  flushCount++;
+  try {
+    storage.sync();
+  } catch (const std::exception& e) {
+    ok = false;
+  }
+
+  lock.lock();
+  if (!ok) {
+    failedFrom = durableSeq + 1;
+    failedTo = target;
+  }
+  durableSeq = target;
+  isFlushing = false;
+  durableCond.notify_all();
+}
+
+/// @brief Commits the writes of the calling operation according to the durability mode.
+/// Blocks until they are durable in the SYNC and GROUP modes. In GROUP mode the first
+/// operation to commit flushes right away, and the ones committed while it flushes share
+/// the next flush, led by one of them. Batches grow with the load, and a lone operation
+/// never waits for a timer or another thread
+/// @param plid Player whose writes are committed
+/// @throws DBFilesystemError if the flush or one of the player's writes failed
+void Durability::commit(const uint32_t plid) {
+  switch (mode) {
+    case DurabilityMode::NONE:
+      return;  // Failed writes are only logged by the backend
+    case DurabilityMode::SYNC:
+      flushCount++;
+      storage.sync();
+      if (storage.writeFailed(plid)) {
+        throw DBFilesystemError();
+      }
+      return;
+    case DurabilityMode::GROUP:
+    default:
+      break;
+  }
+
+  std::unique_lock<std::mutex> lock(commitMutex);
+  uint64_t seq = ++committedSeq;
+
+  while (durableSeq < seq) {
+    if (isFlushing) {
+      durableCond.wait(lock);
+    } else {
+      flushGroup(lock);
+    }
+  }
+
+  if ((seq >= failedFrom && seq <= failedTo) || storage.writeFailed(plid)) {
+    throw DBFilesystemError();
+  }
+}
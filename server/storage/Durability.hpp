@@ -0,0 +1,48 @@
+#ifndef SERVER_DURABILITY_HPP
+#define SERVER_DURABILITY_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "Storage.hpp"
+
+/// NONE: never flushes. SYNC: flushes after every operation. GROUP: operations
+/// committed while a flush runs share the next one. SYNC and GROUP hold the caller (and so
+/// the reply) until its writes are durable, and fail it if the flush or one of its own
+/// writes failed (a failed write of another player is not reported to it). The caller
+/// changes the resident state before committing, so it can release its lock meanwhile:
+/// when the commit fails the GameStore rolls the player's state back and replies ERR, and
+/// holds the player's next request until then. The storage may still hold the failed
+/// writes, so the change can reappear after a restart, as with any unacknowledged write
+enum class DurabilityMode { NONE, SYNC, GROUP };
+
+DurabilityMode strToDurabilityMode(const std::string& str);
+
+class Durability {
+ private:
+  Storage& storage;
+  DurabilityMode mode;
+
+  std::mutex commitMutex;
+  std::condition_variable durableCond;
+  uint64_t committedSeq = 0;  // Operations committed so far
+  uint64_t durableSeq = 0;    // Operations known to be durable
+  uint64_t failedFrom = 0;    // Range of operations whose flush has failed
+  uint64_t failedTo = 0;
+  bool isFlushing = false;  // A committing operation is flushing for the group
+  std::atomic<uint64_t> flushCount = 0;
+
+  void flushGroup(std::unique_lock<std::mutex>& lock);
+
+ public:
+  Durability(Storage& storage, const DurabilityMode mode);
+
+  bool isStrict() const { return mode != DurabilityMode::NONE; }
+  void commit(const uint32_t plid);
+  uint64_t getFlushes() const { return flushCount.load(); }
+};
+
+#endif
@@ -0,0 +1,288 @@
+#include "HistoryIndex.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "../../common/constants.hpp"
+#include "../../common/utils.hpp"
+#include "../Game.hpp"
+#include "../exceptions/ServerExceptions.hpp"
+
+namespace fs = std::filesystem;
+
+#define HISTORY_TAIL_REFS 8  // Last references checked for duplicates on append
+
+/// @brief Writes a whole buffer at an offset of a file
+/// @return `false` on failure
+static bool writeAt(const int fd, const char* buffer, const size_t size, off_t offset) {
+  size_t written = 0;
+  while (written < size) {
+    ssize_t wr = pwrite(fd, buffer + written, size - written, offset + written);
+    if (wr < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    written += static_cast<size_t>(wr);
+  }
+  return true;
+}
+
+/// @brief Flushes a file or directory given its path
+/// @return `false` on failure
+static bool syncPath(const fs::path& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return false;
+  }
+
+  int err = fsync(fd);
+  close(fd);
+  return err == 0;
+}
+
+/// @brief Creates the index over a directory, moving a flat index into the shards
+/// @param dir Index directory
+/// @param order_shift Low bits of a reference that are not part of its order key
+HistoryIndex::HistoryIndex(const fs::path& dir, const unsigned order_shift)
+    : dir(dir), orderShift(order_shift) {
+  migrateFlat();
+}
+
+/// @brief Returns the path of the index file of a player under an index root (Ex:
+/// `<root>/56/34/123456.idx`)
+/// @param root Index directory
+/// @param plid Player ID
+fs::path HistoryIndex::indexPath(const fs::path& root, const uint32_t plid) const {
+  std::string plid_str = plidToStr(plid);
+  return root / plid_str.substr(4, 2) / plid_str.substr(2, 2) / (plid_str + ".idx");
+}
+
+/// @brief Returns the path of the index file of a player
+/// @param plid Player ID
+fs::path HistoryIndex::indexPath(const uint32_t plid) const {
+  return indexPath(dir, plid);
+}
+
+/// @brief Moves the files of an index from before the shards (`<dir>/<plid>.idx`) into
+/// their shards. Each move is a rename, so an interrupted migration resumes on the next
+/// start
+void HistoryIndex::migrateFlat() {
+  std::set<fs::path> dirs;
+
+  try {
+    if (!fs::is_directory(dir)) return;
+
+    for (const auto& entry : fs::directory_iterator(dir)) {
+      std::string name = entry.path().stem().string();
+      if (!entry.is_regular_file() || entry.path().extension() != ".idx" ||
+          name.size() != PLID_LEN || !std::all_of(name.begin(), name.end(), ::isdigit)) {
+        continue;
+      }
+
+      fs::path path = indexPath(strToPlid(name));
+      if (fs::create_directories(path.parent_path())) {
+        dirs.insert(path.parent_path().parent_path());
+      }
+      fs::rename(entry.path(), path);
+      dirs.insert(dir);
+      dirs.insert(path.parent_path());
+    }
+  } catch (const std::exception& e) {
+    throw DBFilesystemError();
+  }
+
+  for (const fs::path& path : dirs) {
+    if (!syncPath(path)) {
+      throw DBFilesystemError();
+    }
+  }
+}
+
+/// @brief Checks if the index was built. Backends rebuild it from their own data
+/// otherwise
+bool HistoryIndex::exists() const { return fs::is_directory(dir); }
+
+/// @brief Appends finished games to the history of a player, skipping the ones ordered
+/// before its last one and the ones already among its last `HISTORY_TAIL_REFS`. Appends
+/// to the same player must be serialized
+/// @param plid Player ID
+/// @param refs Finished game references, oldest first
+void HistoryIndex::append(const uint32_t plid, const std::vector<GameRef>& refs) {
+  if (refs.empty()) {
+    return;
+  }
+
+  fs::path path = indexPath(plid);
+  int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd == -1 && errno == ENOENT) {
+    // First player of its shard
+    std::error_code err;
+    bool created_shard = !fs::is_directory(path.parent_path().parent_path(), err);
+    if (fs::create_directories(path.parent_path(), err)) {
+      std::lock_guard<std::mutex> lock(dirtyMutex);
+      dirtyDirs.insert(path.parent_path().parent_path());
+      if (created_shard) dirtyDirs.insert(dir);
+    }
+    fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  }
+  if (fd == -1) {
+    throw DBFilesystemError();
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    close(fd);
+    throw DBFilesystemError();
+  }
+
+  off_t end = st.st_size - st.st_size % static_cast<off_t>(sizeof(GameRef));
+  size_t num_tail = std::min<size_t>(static_cast<size_t>(end) / sizeof(GameRef),
+                                     HISTORY_TAIL_REFS);
+  std::vector<GameRef> tail(num_tail);
+  off_t tail_size = static_cast<off_t>(num_tail * sizeof(GameRef));
+  if (num_tail > 0 && pread(fd, tail.data(), tail_size, end - tail_size) != tail_size) {
+    close(fd);
+    throw DBFilesystemError();
+  }
+
+  std::vector<GameRef> pending;
+  for (GameRef ref : refs) {
+    bool is_new = tail.empty() || (ref >> orderShift) > (tail.back() >> orderShift) ||
+                  ((ref >> orderShift) == (tail.back() >> orderShift) &&
+                   std::find(tail.begin(), tail.end(), ref) == tail.end());
+    if (is_new) {
+      pending.push_back(ref);
+      tail.push_back(ref);
+    }
+  }
+
+  bool ok = writeAt(fd, reinterpret_cast<const char*>(pending.data()),
+                    pending.size() * sizeof(GameRef), end);
+  close(fd);
+  if (!ok) {
+    throw DBFilesystemError();
+  }
+
+  std::lock_guard<std::mutex> lock(dirtyMutex);
+  dirtyPlids.insert(plid);
+  if (st.st_size == 0) dirtyDirs.insert(path.parent_path());
+}
+
+/// @brief Atomically replaces the whole index. It is built in a temporary directory that
+/// is only renamed into place once durable, so an interrupted rebuild is started over
+/// @param history Finished games of every player, oldest first
+void HistoryIndex::rebuild(
+    const std::unordered_map<uint32_t, std::vector<GameRef>>& history) {
+  fs::path tmp_dir = dir;
+  tmp_dir += ".tmp";
+
+  try {
+    fs::remove_all(tmp_dir);
+    fs::create_directories(tmp_dir);
+  } catch (const fs::filesystem_error& e) {
+    throw DBFilesystemError();
+  }
+
+  for (const auto& [plid, refs] : history) {
+    fs::path path = indexPath(tmp_dir, plid);
+    std::error_code err;
+    fs::create_directories(path.parent_path(), err);
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+      throw DBFilesystemError();
+    }
+
+    bool ok = writeAt(fd, reinterpret_cast<const char*>(refs.data()),
+                      refs.size() * sizeof(GameRef), 0);
+    close(fd);
+    if (!ok) {
+      throw DBFilesystemError();
+    }
+  }
+
+  // One filesystem wide flush instead of one per player file
+  int dir_fd = open(tmp_dir.c_str(), O_RDONLY);
+  if (dir_fd == -1 || syncfs(dir_fd) == -1) {
+    if (dir_fd != -1) close(dir_fd);
+    throw DBFilesystemError();
+  }
+  close(dir_fd);
+
+  try {
+    fs::remove_all(dir);
+    fs::rename(tmp_dir, dir);
+  } catch (const fs::filesystem_error& e) {
+    throw DBFilesystemError();
+  }
+  if (!syncPath(dir.parent_path())) {
+    throw DBFilesystemError();
+  }
+}
+
+/// @brief Reads a page of the history of a player, newest first
+/// @param plid Player ID
+/// @param offset Number of most recent games to skip
+/// @param count Maximum number of games to read
+/// @param refs Will store the references of the page
+/// @return Number of finished games of the player
+size_t HistoryIndex::read(const uint32_t plid, const size_t offset, const size_t count,
+                          std::vector<GameRef>& refs) {
+  refs.clear();
+
+  int fd = open(indexPath(plid).c_str(), O_RDONLY);
+  if (fd == -1) {
+    if (errno == ENOENT) return 0;
+    throw DBFilesystemError();
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    close(fd);
+    throw DBFilesystemError();
+  }
+
+  size_t total = static_cast<size_t>(st.st_size) / sizeof(GameRef);
+  if (offset >= total || count == 0) {
+    close(fd);
+    return total;
+  }
+
+  size_t n = std::min(count, total - offset);
+  size_t first = total - offset - n;
+  refs.resize(n);
+  ssize_t rd = pread(fd, refs.data(), n * sizeof(GameRef),
+                     static_cast<off_t>(first * sizeof(GameRef)));
+  close(fd);
+  if (rd != static_cast<ssize_t>(n * sizeof(GameRef))) {
+    throw DBFilesystemError();
+  }
+
+  std::reverse(refs.begin(), refs.end());
+  return total;
+}
+
+/// @brief Flushes every index file appended to since the last sync
+void HistoryIndex::sync() {
+  std::lock_guard<std::mutex> sync_lock(syncMutex);
+  std::unordered_set<uint32_t> plids;
+  std::set<fs::path> dirs;
+  {
+    std::lock_guard<std::mutex> lock(dirtyMutex);
+    plids.swap(dirtyPlids);
+    dirs.swap(dirtyDirs);
+  }
+
+  for (uint32_t plid : plids) {
+    if (!syncPath(indexPath(plid))) {
+      throw DBFilesystemError();
+    }
+  }
+  for (const fs::path& path : dirs) {
+    if (!syncPath(path)) {
+      throw DBFilesystemError();
+    }
+  }
+}
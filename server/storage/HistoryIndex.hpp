@@ -0,0 +1,53 @@
+#ifndef SERVER_HISTORY_INDEX_HPP
+#define SERVER_HISTORY_INDEX_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Storage.hpp"
+
+/// Finished games of every player, oldest first, as one `<plid>.idx` file per player
+/// holding the backend's references to them (8 bytes each). Files live in a two-level
+/// shard named after digits 5-6 and 3-4 of the PLID, like the text backend's `GAMES/`,
+/// and flat indexes from before the shards are moved into them when opened. A page of
+/// a player's history is a single read at a computed offset. References are ordered by
+/// `ref >> orderShift`, the low bits telling apart games that share an order key (text
+/// references are `(tstamp << 8) | ending`). Appends skip the references that are older
+/// than the last one or already among the last ones, so replaying finished games at
+/// startup can't duplicate them. Bytes after the last complete reference (a torn append)
+/// are ignored and overwritten
+class HistoryIndex {
+ private:
+  std::filesystem::path dir;
+  unsigned orderShift;
+
+  // Files and directories changed since the last sync
+  std::mutex dirtyMutex;
+  std::unordered_set<uint32_t> dirtyPlids;
+  std::set<std::filesystem::path> dirtyDirs;
+  // Held for a whole sync, so a concurrent one can't return before the files it took away
+  // are flushed
+  std::mutex syncMutex;
+
+  std::filesystem::path indexPath(const std::filesystem::path& root,
+                                  const uint32_t plid) const;
+  std::filesystem::path indexPath(const uint32_t plid) const;
+  void migrateFlat();
+
+ public:
+  HistoryIndex(const std::filesystem::path& dir, const unsigned order_shift = 0);
+
+  bool exists() const;
+  void append(const uint32_t plid, const std::vector<GameRef>& refs);
+  void rebuild(const std::unordered_map<uint32_t, std::vector<GameRef>>& history);
+  size_t read(const uint32_t plid, const size_t offset, const size_t count,
+              std::vector<GameRef>& refs);
+  void sync();
+};
+
+#endif
@@ -0,0 +1,232 @@
+#include "IoRing.hpp"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include "../../common/constants.hpp"
+#include "../exceptions/ServerExceptions.hpp"
+
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup) && \
+    defined(__NR_io_uring_enter)
+#include <linux/io_uring.h>
+#define HAS_IO_URING 1
+#else
+#define HAS_IO_URING 0
+#endif
+
+/// @brief Sets up the ring. Stays on the blocking calls if that fails
+IoRing::IoRing() { setup(); }
+
+/// @brief Releases the ring
+IoRing::~IoRing() { teardown(); }
+
+/// @brief Creates the ring and maps its submission queue, completion queue and
+/// submission entries
+void IoRing::setup() {
+#if HAS_IO_URING
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+
+  int fd = static_cast<int>(syscall(__NR_io_uring_setup, IO_RING_ENTRIES, &params));
+  if (fd < 0) {
+    return;  // No io_uring (ENOSYS) or not allowed (EPERM)
+  }
+  ringFd = fd;
+
+  sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap) {
+    sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+  }
+
+  sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                ringFd, IORING_OFF_SQ_RING);
+  if (sqRing == MAP_FAILED) {
+    sqRing = nullptr;
+    teardown();
+    return;
+  }
+
+  if (single_mmap) {
+    cqRing = sqRing;
+  } else {
+    cqRing = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                  ringFd, IORING_OFF_CQ_RING);
+    if (cqRing == MAP_FAILED) {
+      cqRing = nullptr;
+      teardown();
+      return;
+    }
+  }
+
+  sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+  sqes = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+              ringFd, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    sqes = nullptr;
+    teardown();
+    return;
+  }
+
+  char* sq = static_cast<char*>(sqRing);
+  char* cq = static_cast<char*>(cqRing);
+  sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+  sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+  sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+  cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+  cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+  cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+  cqes = cq + params.cq_off.cqes;
+  entries = params.sq_entries;
+#endif
+}
+
+/// @brief Unmaps and closes the ring, if any. Later operations use the blocking calls
+void IoRing::teardown() {
+  if (sqes != nullptr) munmap(sqes, sqesSize);
+  if (cqRing != nullptr && cqRing != sqRing) munmap(cqRing, cqRingSize);
+  if (sqRing != nullptr) munmap(sqRing, sqRingSize);
+  if (ringFd != -1) close(ringFd);
+
+  sqes = cqRing = sqRing = nullptr;
+  ringFd = -1;
+}
+
+/// @brief Queues a write of a buffer at an offset of a file. The buffer must stay valid
+/// until `submit` returns
+void IoRing::write(const int fd, const void* buffer, const size_t size,
+                   const off_t offset) {
+  ops.push_back({fd, static_cast<const char*>(buffer), size, offset, false});
+}
+
+/// @brief Queues a data flush of a file, carried out after every queued write
+void IoRing::sync(const int fd) { ops.push_back({fd, nullptr, 0, 0, true}); }
+
+/// @brief Submits the queued operations and waits for all of them to complete. Anything
+/// the ring could not complete (short writes, opcodes older kernels lack) is redone
+/// with blocking calls, in order
+/// @throws DBFilesystemError if an operation failed
+void IoRing::submit() {
+  std::vector<size_t> done(ops.size(), 0);  // Bytes written by the ring (1: flushed)
+
+  for (size_t first = 0; isAvailable() && first < ops.size(); first += entries) {
+    if (!submitRing(first, std::min<size_t>(entries, ops.size() - first), done)) {
+      teardown();
+    }
+  }
+
+  // A flush after a redone write may have run before it, so it is redone too
+  bool ok = true;
+  bool redone = false;
+  for (size_t i = 0; i < ops.size(); ++i) {
+    const Op& op = ops[i];
+    bool completed = op.isSync ? done[i] == 1 && !redone : done[i] == op.size;
+    if (completed) continue;
+
+    redone = true;
+    ok = runOp(op, op.isSync ? 0 : done[i]) && ok;
+  }
+
+  ops.clear();
+  if (!ok) {
+    throw DBFilesystemError();
+  }
+}
+
+/// @brief Submits a run of queued operations as one batch and reaps their completions
+/// @param first Index of the first operation
+/// @param count Number of operations, at most the ring's size
+/// @param done Will store the bytes written by each write and `1` for each flush
+/// @return `false` if the ring itself failed
+bool IoRing::submitRing(const size_t first, const size_t count,
+                        std::vector<size_t>& done) {
+#if HAS_IO_URING
+  io_uring_sqe* sqe_array = static_cast<io_uring_sqe*>(sqes);
+  unsigned tail = *sqTail;
+
+  for (size_t i = first; i < first + count; ++i) {
+    const Op& op = ops[i];
+    unsigned idx = tail++ & *sqMask;
+    io_uring_sqe* sqe = &sqe_array[idx];
+
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->fd = op.fd;
+    sqe->user_data = i;
+    if (op.isSync) {
+      sqe->opcode = IORING_OP_FSYNC;
+      sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+      sqe->flags = IOSQE_IO_DRAIN;  // Starts once the operations before it completed
+    } else {
+      sqe->opcode = IORING_OP_WRITE;
+      sqe->addr = reinterpret_cast<uintptr_t>(op.buffer);
+      sqe->len = static_cast<uint32_t>(op.size);
+      sqe->off = static_cast<uint64_t>(op.offset);
+    }
+    sqArray[idx] = idx;
+  }
+  __atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+
+  const io_uring_cqe* cqe_array = static_cast<const io_uring_cqe*>(cqes);
+  size_t submitted = 0;
+  size_t reaped = 0;
+
+  while (reaped < count) {
+    unsigned head = *cqHead;
+    if (head != __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+      const io_uring_cqe& cqe = cqe_array[head & *cqMask];
+      size_t i = static_cast<size_t>(cqe.user_data);
+      if (cqe.res >= 0) {
+        done[i] = ops[i].isSync ? 1 : static_cast<size_t>(cqe.res);
+      }
+
+      __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+      reaped++;
+      continue;
+    }
+
+    // Submits whatever is left of the batch and waits for a completion
+    long ret = syscall(__NR_io_uring_enter, ringFd, count - submitted, 1,
+                       IORING_ENTER_GETEVENTS, nullptr, 0);
+    if (ret < 0) {
+      if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+      return false;
+    }
+    submitted += static_cast<size_t>(ret);
+  }
+  return true;
+#else
+  (void)first;
+  (void)count;
+  (void)done;
+  return false;
+#endif
+}
+
+/// @brief Carries out an operation with blocking calls
+/// @param op Operation
+/// @param done Bytes of the write already written
+/// @return `false` on failure
+bool IoRing::runOp(const Op& op, const size_t done) {
+  if (op.isSync) {
+    return fdatasync(op.fd) == 0;
+  }
+
+  size_t written = done;
+  while (written < op.size) {
+    ssize_t wr = pwrite(op.fd, op.buffer + written, op.size - written,
+                        op.offset + static_cast<off_t>(written));
+    if (wr < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    written += static_cast<size_t>(wr);
+  }
+  return true;
+}
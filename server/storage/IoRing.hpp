@@ -0,0 +1,60 @@
+#ifndef SERVER_IO_RING_HPP
+#define SERVER_IO_RING_HPP
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <vector>
+
+/// Batched submission of positional writes and data flushes. Queued operations are
+/// handed to the kernel through io_uring, up to `IO_RING_ENTRIES` per `io_uring_enter`,
+/// and completed asynchronously. The ring is set up with raw syscalls (no liburing).
+/// Where io_uring is unavailable (older kernels, seccomp filters) the operations are
+/// carried out with pwrite and fdatasync instead. Meant to be owned by a single thread
+class IoRing {
+ private:
+  struct Op {
+    int fd;
+    const char* buffer;
+    size_t size;
+    off_t offset;
+    bool isSync;  // fdatasync, after every operation queued before it
+  };
+
+  int ringFd = -1;
+  void* sqRing = nullptr;
+  size_t sqRingSize = 0;
+  void* cqRing = nullptr;
+  size_t cqRingSize = 0;
+  void* sqes = nullptr;
+  size_t sqesSize = 0;
+  unsigned* sqTail = nullptr;
+  unsigned* sqMask = nullptr;
+  unsigned* sqArray = nullptr;
+  unsigned* cqHead = nullptr;
+  unsigned* cqTail = nullptr;
+  unsigned* cqMask = nullptr;
+  void* cqes = nullptr;
+  unsigned entries = 0;
+
+  std::vector<Op> ops;
+
+  void setup();
+  void teardown();
+  bool submitRing(const size_t first, const size_t count, std::vector<size_t>& done);
+  static bool runOp(const Op& op, const size_t done);
+
+ public:
+  IoRing();
+  ~IoRing();
+
+  IoRing(const IoRing&) = delete;
+  IoRing& operator=(const IoRing&) = delete;
+
+  bool isAvailable() const { return ringFd != -1; };
+  void write(const int fd, const void* buffer, const size_t size, const off_t offset);
+  void sync(const int fd);
+  void submit();
+};
+
+#endif
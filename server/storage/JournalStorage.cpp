@@ -0,0 +1,557 @@
+#include "JournalStorage.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+
+#include "../../common/utils.hpp"
+#include "../exceptions/GameExceptions.hpp"
+#include "../exceptions/ServerExceptions.hpp"
+#include "../utils/crc32.hpp"
+
+namespace fs = std::filesystem;
+
+/// @brief Computes the checksum of a record (every byte after the checksum field)
+static uint32_t recordChecksum(const JournalRecord& record) {
+  const size_t offset = offsetof(JournalRecord, type);
+  return crc32(reinterpret_cast<const unsigned char*>(&record) + offset,
+               sizeof(JournalRecord) - offset);
+}
+
+/// @brief Checks if a record read from disk was completely and correctly written
+static bool isValidRecord(const JournalRecord& record) {
+  return record.magic == JOURNAL_MAGIC && record.checksum == recordChecksum(record);
+}
+
+/// @brief Builds the common game fields of a record
+static void gameToRecord(const Game& game, JournalRecord& record) {
+  record.plid = game.plid;
+  record.mode = static_cast<uint8_t>(game.mode);
+  std::memcpy(record.key, unpackCode(game.key).data(), SECRET_KEY_LEN);
+  record.play_time = game.playTime;
+  record.tstamp_start = game.tstamp_start;
+}
+
+/// @brief Copies an attempt into its record representation
+static void attemptToRecord(const Attempt& attempt, JournalAttempt& record) {
+  std::memcpy(record.key, unpackCode(attempt.key).data(), SECRET_KEY_LEN);
+  record.blacks = static_cast<uint8_t>(attempt.blacks());
+  record.whites = static_cast<uint8_t>(attempt.whites());
+  record.time = attempt.time;
+}
+
+/// @brief Rebuilds an attempt from its record representation
+static Attempt recordToAttempt(const JournalAttempt& record) {
+  Code key = 0;
+  packCode(std::string(record.key, SECRET_KEY_LEN), key);
+  return Attempt(key, record.blacks, record.whites, record.time);
+}
+
+/// @brief Rebuilds a game from a START or END record
+static void recordToGame(const JournalRecord& record, Game& game) {
+  Code key = 0;
+  packCode(std::string(record.key, SECRET_KEY_LEN), key);
+  game = Game(record.plid, key, static_cast<GameMode>(record.mode), record.play_time,
+              static_cast<time_t>(record.tstamp_start));
+
+  if (record.type != JournalRecord::END) {
+    game.status = Game::Status::ACT;
+    return;
+  }
+
+  for (size_t i = 0; i < record.n_attempts && i < GUESSES_MAX; ++i) {
+    game.addAttempt(recordToAttempt(record.attempts[i]));
+  }
+
+  game.usedTime = static_cast<uint16_t>(record.used_time);
+  game.ending = static_cast<Endings>(record.ending);
+  game.status = Game::Status::FIN;
+}
+
+/// @brief Names what a record does, for the log
+static const char* recordOpName(const uint8_t type) {
+  switch (type) {
+    case JournalRecord::START:
+      return "new game";
+    case JournalRecord::TRY:
+      return "attempt";
+    case JournalRecord::END:
+      return "game ending";
+    case JournalRecord::SCORE:
+    default:
+      return "score";
+  }
+}
+
+/// @brief Initializes the journal directory
+/// @param dir Database directory
+/// @param logger Logger the failed writes are reported to
+JournalStorage::JournalStorage(const fs::path& dir, Logger& logger)
+    : journalDir(dir / "JOURNAL"),
+      historyIndex(dir / "JOURNAL" / "HISTORY"),
+      writeQueue([this](std::vector<PendingRecord>& batch,
+                        std::vector<bool>&) { writeRecords(batch); },
+                 logger) {
+  fs::create_directory(journalDir);
+}
+
+/// @brief Writes the queued records and closes the current segment
+JournalStorage::~JournalStorage() {
+  writeQueue.stop();
+  if (segmentFd != -1) {
+    close(segmentFd);
+  }
+}
+
+/// @brief Returns the path of the n-th segment file
+fs::path JournalStorage::segmentPath(const uint32_t n) {
+  std::ostringstream fname;
+  fname << std::setw(8) << std::setfill('0') << n << ".seg";
+  return journalDir / fname.str();
+}
+
+/// @brief Opens (and preallocates, if new) the n-th segment as the one records are
+/// written to. The previous segment must have been flushed
+/// @param n Segment number
+void JournalStorage::openSegment(const uint32_t n) {
+  fs::path path = segmentPath(n);
+  bool created = !fs::exists(path);
+
+  int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd == -1) {
+    throw DBFilesystemError();
+  }
+
+  // Preallocating keeps appends from having to extend the file, so later syncs only
+  // need to flush data
+  if (posix_fallocate(fd, 0, JOURNAL_SEGMENT_SIZE) != 0) {
+    close(fd);
+    throw DBFilesystemError();
+  }
+
+  if (created) {
+    int dir_fd = open(journalDir.c_str(), O_RDONLY);
+    if (fsync(fd) == -1 || dir_fd == -1 || fsync(dir_fd) == -1) {
+      if (dir_fd != -1) close(dir_fd);
+      close(fd);
+      throw DBFilesystemError();
+    }
+    close(dir_fd);
+  }
+
+  int old_fd;
+  {
+    std::lock_guard<std::mutex> lock(segmentMutex);
+    old_fd = segmentFd;
+    segmentFd = fd;
+    segmentFdNo = n;
+  }
+
+  if (old_fd != -1) {
+    close(old_fd);
+  }
+}
+
+/// @brief Zeroes the open segment from a record index to its end. Batched writes may
+/// reach the disk out of order, so a crash can leave valid records after the first
+/// invalid one. Appends resume at that hole, and once they filled it the stale records
+/// after it would be replayed as if they were new
+/// @param pos Index of the first record to clear
+void JournalStorage::clearSegmentTail(const uint32_t pos) {
+  std::vector<char> chunk(64 * JOURNAL_RECORD_SIZE);
+  const std::vector<char> zeros(chunk.size(), 0);
+  bool cleared = false;
+
+  for (off_t off = static_cast<off_t>(pos) * JOURNAL_RECORD_SIZE;
+       off < JOURNAL_SEGMENT_SIZE; off += static_cast<off_t>(chunk.size())) {
+    size_t len = std::min<size_t>(chunk.size(), JOURNAL_SEGMENT_SIZE - off);
+    ssize_t rd = pread(segmentFd, chunk.data(), len, off);
+    if (rd < 0) {
+      throw DBFilesystemError();
+    }
+    if (std::all_of(chunk.begin(), chunk.begin() + rd, [](char c) { return c == 0; })) {
+      continue;  // Only rewritten where something was left behind
+    }
+
+    if (pwrite(segmentFd, zeros.data(), len, off) != static_cast<ssize_t>(len)) {
+      throw DBFilesystemError();
+    }
+    cleared = true;
+  }
+
+  // Durable before any new record can land in front of the cleared ones
+  if (cleared && fdatasync(segmentFd) == -1) {
+    throw DBFilesystemError();
+  }
+}
+
+/// @brief Replays the valid records of a segment into the resident state
+/// @param n Segment number
+/// @param start Index of the first record to replay
+/// @param active_games Active games table
+/// @param last_finished Last finished game of each player
+/// @param stats Finished games totals of each player
+/// @param scoreboard Top scores index
+/// @return Number of valid records in the segment
+uint32_t JournalStorage::replaySegment(
+    const uint32_t n, const uint32_t start,
+    std::unordered_map<uint32_t, Game>& active_games,
+    std::unordered_map<uint32_t, GameRef>& last_finished,
+    std::unordered_map<uint32_t, PlayerStats>& stats, Scoreboard& scoreboard) {
+  int fd = open(segmentPath(n).c_str(), O_RDONLY);
+  if (fd == -1) {
+    throw DBFilesystemError();
+  }
+
+  std::vector<JournalRecord> chunk(256);
+  uint32_t pos = start;
+  bool done = false;
+
+  while (!done && pos < JOURNAL_SEGMENT_RECORDS) {
+    ssize_t rd = pread(fd, chunk.data(), chunk.size() * sizeof(JournalRecord),
+                       static_cast<off_t>(pos) * sizeof(JournalRecord));
+    if (rd < 0) {
+      close(fd);
+      throw DBFilesystemError();
+    }
+
+    size_t count = static_cast<size_t>(rd) / sizeof(JournalRecord);
+    if (count == 0) break;
+
+    for (size_t i = 0; i < count; ++i) {
+      const JournalRecord& record = chunk[i];
+      if (!isValidRecord(record)) {
+        done = true;  // End of written records (or a torn write)
+        break;
+      }
+
+      uint32_t plid = record.plid;
+      switch (record.type) {
+        case JournalRecord::START:
+          recordToGame(record, active_games[plid]);
+          break;
+        case JournalRecord::TRY: {
+          auto it = active_games.find(plid);
+          if (it == active_games.end()) break;
+
+          it->second.addAttempt(recordToAttempt(record.attempts[0]));
+          break;
+        }
+        case JournalRecord::END:
+          active_games.erase(plid);
+          last_finished[plid] = (static_cast<GameRef>(n) << 32) | pos;
+          replayedHistory[plid].push_back(last_finished[plid]);
+          stats[plid].addGame(static_cast<Endings>(record.ending), record.n_attempts);
+          break;
+        case JournalRecord::SCORE:
+          stats[plid].addScore(record.score);
+          scoreboard.insert(LeaderboardEntry(record.score, plidToStr(plid),
+                                             std::string(record.key, SECRET_KEY_LEN),
+                                             record.n_attempts,
+                                             static_cast<GameMode>(record.mode)));
+          break;
+        default:
+          break;
+      }
+      pos++;
+    }
+  }
+
+  close(fd);
+  return pos;
+}
+
+/// @brief Replays every segment in order, rebuilding the active games, the last finished
+/// game and totals of each player and the top scores. Appends resume after the last
+/// valid record
+/// @param active_games Active games table
+/// @param last_finished Last finished game of each player
+/// @param stats Finished games totals of each player
+/// @param scoreboard Top scores index
+void JournalStorage::load(std::unordered_map<uint32_t, Game>& active_games,
+                          std::unordered_map<uint32_t, GameRef>& last_finished,
+                          std::unordered_map<uint32_t, PlayerStats>& stats,
+                          Scoreboard& scoreboard) {
+  replayFrom(0, active_games, last_finished, stats, scoreboard);
+}
+
+/// @brief Replays the records logged after a snapshot on top of its state
+/// @param pos Journal position of the snapshot
+/// @param active_games Active games table, as of the snapshot
+/// @param last_finished Last finished game of each player, as of the snapshot
+/// @param stats Finished games totals of each player, as of the snapshot
+/// @param scoreboard Top scores index, as of the snapshot
+/// @return `false` if the journal no longer holds the snapshot's position, or if the
+/// history index has to be built from the whole journal
+bool JournalStorage::loadFrom(const uint64_t pos,
+                              std::unordered_map<uint32_t, Game>& active_games,
+                              std::unordered_map<uint32_t, GameRef>& last_finished,
+                              std::unordered_map<uint32_t, PlayerStats>& stats,
+                              Scoreboard& scoreboard) {
+  return pos != 0 && historyIndex.exists() &&
+         replayFrom(pos, active_games, last_finished, stats, scoreboard);
+}
+
+/// @brief Replays every record from a journal position onwards, brings the history index
+/// up to date with the replayed END records and opens the last segment for appending
+/// @param pos Position of the first record (segment number << 32 | record index)
+/// @param active_games Active games table
+/// @param last_finished Last finished game of each player
+/// @param stats Finished games totals of each player
+/// @param scoreboard Top scores index
+/// @return `false` if the position's segment does not exist (nothing is replayed)
+bool JournalStorage::replayFrom(const uint64_t pos,
+                                std::unordered_map<uint32_t, Game>& active_games,
+                                std::unordered_map<uint32_t, GameRef>& last_finished,
+                                std::unordered_map<uint32_t, PlayerStats>& stats,
+                                Scoreboard& scoreboard) {
+  std::lock_guard<std::mutex> lock(journalMutex);
+  std::vector<uint32_t> segments;
+  const uint32_t first_segment = static_cast<uint32_t>(pos >> 32);
+  const uint32_t first_record = static_cast<uint32_t>(pos & 0xffffffffu);
+
+  try {
+    for (const auto& entry : fs::directory_iterator(journalDir)) {
+      if (entry.is_regular_file() && entry.path().extension() == ".seg") {
+        segments.push_back(std::stoul(entry.path().stem().string()));
+      }
+    }
+  } catch (const std::exception& e) {
+    throw DBFilesystemError();
+  }
+
+  std::sort(segments.begin(), segments.end());
+  if (pos != 0 && !std::binary_search(segments.begin(), segments.end(), first_segment)) {
+    return false;
+  }
+
+  uint32_t last_pos = 0;
+  for (uint32_t n : segments) {
+    if (n < first_segment) continue;
+
+    last_pos = replaySegment(n, n == first_segment ? first_record : 0, active_games,
+                             last_finished, stats, scoreboard);
+  }
+
+  // A full replay met every finished game, so a missing index is built from it
+  if (!historyIndex.exists()) {
+    historyIndex.rebuild(replayedHistory);
+  } else {
+    for (const auto& [plid, refs] : replayedHistory) {
+      historyIndex.append(plid, refs);
+    }
+  }
+  replayedHistory.clear();
+
+  segmentNo = segments.empty() ? 1 : segments.back();
+  segmentPos = last_pos;
+  openSegment(segmentNo);
+  clearSegmentTail(segmentPos);
+  writtenPos = (static_cast<uint64_t>(segmentNo) << 32) | segmentPos;
+  return true;
+}
+
+/// @brief Appends a record to the journal, rotating to a new segment when full. The
+/// location is reserved right away, while the record is queued for the writer thread
+/// @param record Record to append (magic and checksum are filled in)
+/// @return Location of the record (segment number << 32 | record index)
+uint64_t JournalStorage::append(JournalRecord& record) {
+  record.magic = JOURNAL_MAGIC;
+  record.checksum = recordChecksum(record);
+
+  // Queued under the lock, so the writer receives records in location order
+  std::lock_guard<std::mutex> lock(journalMutex);
+  if (segmentPos >= JOURNAL_SEGMENT_RECORDS) {
+    segmentNo++;
+    segmentPos = 0;
+  }
+
+  uint64_t loc = (static_cast<uint64_t>(segmentNo) << 32) | segmentPos++;
+  writeQueue.push(record.plid, recordOpName(record.type), {loc, record});
+  return loc;
+}
+
+/// @brief Writes a batch of queued records (writer thread). Runs of consecutive records
+/// take a single write, submitted together with the other runs of the batch, and END
+/// records are then added to their player's history
+/// @param batch Records in location order
+void JournalStorage::writeRecords(std::vector<PendingRecord>& batch) {
+  std::vector<JournalRecord> records;
+  records.reserve(batch.size());  // Never reallocated while writes are queued
+  size_t i = 0;
+
+  while (i < batch.size()) {
+    const uint64_t first = batch[i].loc;
+    const size_t start = i;
+    // A run also ends where the next record starts a new segment
+    while (i < batch.size() && batch[i].loc == first + (i - start)) {
+      records.push_back(batch[i++].record);
+    }
+
+    const uint32_t n = static_cast<uint32_t>(first >> 32);
+    if (segmentFd == -1 || n != segmentFdNo) {
+      // Records of the previous segment must not be left behind by the next sync, which
+      // only flushes the current one
+      if (segmentFd != -1) ioRing.sync(segmentFd);
+      ioRing.submit();
+      openSegment(n);
+    }
+
+    ioRing.write(segmentFd, records.data() + start, (i - start) * sizeof(JournalRecord),
+                 static_cast<off_t>(first & 0xffffffffu) * sizeof(JournalRecord));
+  }
+  ioRing.submit();
+
+  for (const PendingRecord& pending : batch) {
+    if (pending.record.type == JournalRecord::END) {
+      historyIndex.append(pending.record.plid, {pending.loc});
+    }
+  }
+  writtenPos = batch.back().loc + 1;
+}
+
+/// @brief Appends a game-start record
+/// @param game New game
+void JournalStorage::createGame(const Game& game) {
+  JournalRecord record{};
+  record.type = JournalRecord::START;
+  gameToRecord(game, record);
+  append(record);
+}
+
+/// @brief Appends a try record
+/// @param game Active game
+/// @param attempt New attempt
+void JournalStorage::addAttempt(const Game& game, const Attempt& attempt) {
+  JournalRecord record{};
+  record.type = JournalRecord::TRY;
+  record.plid = game.plid;
+  record.n_attempts = static_cast<uint8_t>(game.numAttempts + 1);
+  attemptToRecord(attempt, record.attempts[0]);
+  append(record);
+}
+
+/// @brief Appends an end record holding the complete game. The writer thread adds it to
+/// the history of its player
+/// @param game Active game
+/// @param reason Ending reason (WIN, LOSS, QUIT, TIMEOUT)
+/// @param tstamp Ending timestamp
+/// @param used_time Total used time for this game (seconds)
+/// @return Location of the end record
+GameRef JournalStorage::endGame(const Game& game, const Endings reason,
+                                const time_t& tstamp, const int used_time) {
+  JournalRecord record{};
+  record.type = JournalRecord::END;
+  gameToRecord(game, record);
+  record.ending = static_cast<uint8_t>(reason);
+  record.tstamp = tstamp;
+  record.used_time = used_time;
+  record.n_attempts = game.numAttempts;
+  for (size_t i = 0; i < game.numAttempts; ++i) {
+    attemptToRecord(game.attempts[i], record.attempts[i]);
+  }
+
+  return append(record);
+}
+
+/// @brief Appends a score record
+/// @param entry Score entry
+/// @param tstamp Timestamp of win
+void JournalStorage::saveScore(const LeaderboardEntry& entry, const time_t& tstamp) {
+  JournalRecord record{};
+  record.type = JournalRecord::SCORE;
+  record.plid = strToPlid(entry.plid);
+  record.mode = static_cast<uint8_t>(entry.mode);
+  std::memcpy(record.key, entry.key.data(), SECRET_KEY_LEN);
+  record.n_attempts = static_cast<uint8_t>(entry.used_atts);
+  record.score = entry.score;
+  record.tstamp = tstamp;
+  append(record);
+}
+
+/// @brief Reads the END record of a finished game, waiting for it to be written if it is
+/// still queued
+/// @param plid Player ID
+/// @param ref Location of the end record
+/// @param game Will store the finished game
+void JournalStorage::readFinishedGame(const uint32_t plid, const GameRef ref,
+                                      Game& game) {
+  if (ref >= writtenPos) {
+    writeQueue.flush();
+  }
+
+  int fd = open(segmentPath(static_cast<uint32_t>(ref >> 32)).c_str(), O_RDONLY);
+  if (fd == -1) {
+    throw DBFilesystemError();
+  }
+
+  JournalRecord record;
+  off_t offset = static_cast<off_t>(ref & 0xffffffffu) * sizeof(JournalRecord);
+  ssize_t rd = pread(fd, &record, sizeof(record), offset);
+  close(fd);
+
+  if (rd != sizeof(record) || !isValidRecord(record) ||
+      record.type != JournalRecord::END || record.plid != plid) {
+    throw DBFilesystemError();
+  }
+
+  recordToGame(record, game);
+}
+
+/// @brief Writes the queued records, then flushes the current segment and the history
+/// index. Appends are not blocked while flushing
+void JournalStorage::sync() {
+  writeQueue.flush();
+
+  int fd;
+  {
+    std::lock_guard<std::mutex> lock(segmentMutex);
+    fd = dup(segmentFd);
+  }
+
+  if (fd == -1) {
+    throw DBFilesystemError();
+  }
+
+  int err = fdatasync(fd);
+  close(fd);
+  if (err == -1) {
+    throw DBFilesystemError();
+  }
+
+  historyIndex.sync();
+}
+
+/// @brief Takes the failure of a player's records, which the writer thread logged
+/// @param plid Player ID
+/// @return Whether a record of the player failed to be written since it was last asked
+bool JournalStorage::writeFailed(const uint32_t plid) {
+  return writeQueue.takeFailure(plid);
+}
+
+/// @brief Returns the position the next record will be appended at, whether or not the
+/// queued records were written yet. Only consistent with the resident state while no
+/// appends are in flight
+/// @param pos Will store the position (segment number << 32 | record index)
+bool JournalStorage::position(uint64_t& pos) {
+  std::lock_guard<std::mutex> lock(journalMutex);
+  pos = (static_cast<uint64_t>(segmentNo) << 32) | segmentPos;
+  return true;
+}
+
+/// @brief Reads a page of the finished games of a player from the history index, once
+/// the queued records are written
+/// @param plid Player ID
+/// @param offset Number of most recent games to skip
+/// @param count Maximum number of games
+/// @param refs Will store the locations of the END records, newest first
+/// @param total Will store the number of finished games of the player
+bool JournalStorage::history(const uint32_t plid, const size_t offset, const size_t count,
+                             std::vector<GameRef>& refs, size_t& total) {
+  writeQueue.flush();  // END records still queued are not in the index yet
+  total = historyIndex.read(plid, offset, count, refs);
+  return true;
+}
@@ -0,0 +1,121 @@
+#ifndef SERVER_JOURNAL_STORAGE_HPP
+#define SERVER_JOURNAL_STORAGE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include "../../common/constants.hpp"
+#include "HistoryIndex.hpp"
+#include "IoRing.hpp"
+#include "Storage.hpp"
+#include "WriteQueue.hpp"
+
+#define JOURNAL_MAGIC 0x4a4d4d47  // "GMMJ"
+#define JOURNAL_SEGMENT_RECORDS (JOURNAL_SEGMENT_SIZE / JOURNAL_RECORD_SIZE)
+
+struct JournalAttempt {
+  char key[SECRET_KEY_LEN];
+  uint8_t blacks;
+  uint8_t whites;
+  uint16_t time;
+};
+
+/// Fixed-size journal record. END records carry the whole game so a finished game can
+/// be served with a single read
+struct JournalRecord {
+  enum Type : uint8_t { START = 1, TRY, END, SCORE };
+
+  uint32_t magic;
+  uint32_t checksum;  // CRC32 of every byte after this field
+  uint8_t type;
+  uint8_t mode;
+  uint8_t ending;
+  uint8_t n_attempts;  // TRY: trial number; SCORE: used attempts
+  uint32_t plid;
+  char key[SECRET_KEY_LEN];
+  uint32_t play_time;
+  int64_t tstamp_start;
+  int64_t tstamp;  // END: ending timestamp; SCORE: win timestamp
+  int32_t used_time;
+  int32_t score;
+  JournalAttempt attempts[GUESSES_MAX];
+  uint8_t reserved[16];
+};
+
+static_assert(sizeof(JournalRecord) == JOURNAL_RECORD_SIZE,
+              "Journal records must have a fixed on-disk size");
+
+/// Append-only binary journal. Records are written into preallocated segment files under
+/// `JOURNAL/` and replayed at startup to rebuild the resident state. The locations of the
+/// END records of each player are also kept in `JOURNAL/HISTORY/`, to page through
+/// their finished games.
+/// Appending only reserves the record's location: the record is written by the journal's
+/// writer thread, which coalesces consecutive records into a single write and submits the
+/// writes of a batch together through io_uring
+class JournalStorage : public Storage {
+ private:
+  struct PendingRecord {
+    uint64_t loc;
+    JournalRecord record;
+  };
+
+  std::filesystem::path journalDir;
+  std::mutex journalMutex;
+  uint32_t segmentNo = 0;
+  uint32_t segmentPos = 0;  // Next free record in the current segment
+
+  // Segment the writer thread is writing to, whose descriptor `sync` duplicates
+  std::mutex segmentMutex;
+  int segmentFd = -1;
+  uint32_t segmentFdNo = 0;
+  std::atomic<uint64_t> writtenPos = 0;  // Location after the last written record
+  IoRing ioRing;                          // Used by the writer thread only
+
+  HistoryIndex historyIndex;
+  // END records met while replaying, checked against the history index afterwards
+  std::unordered_map<uint32_t, std::vector<GameRef>> replayedHistory;
+
+  WriteQueue<PendingRecord> writeQueue;
+
+  std::filesystem::path segmentPath(const uint32_t n);
+  void openSegment(const uint32_t n);
+  void clearSegmentTail(const uint32_t pos);
+  void writeRecords(std::vector<PendingRecord>& batch);
+  uint32_t replaySegment(const uint32_t n, const uint32_t start,
+                         std::unordered_map<uint32_t, Game>& active_games,
+                         std::unordered_map<uint32_t, GameRef>& last_finished,
+                         std::unordered_map<uint32_t, PlayerStats>& stats,
+                         Scoreboard& scoreboard);
+  bool replayFrom(const uint64_t pos, std::unordered_map<uint32_t, Game>& active_games,
+                  std::unordered_map<uint32_t, GameRef>& last_finished,
+                  std::unordered_map<uint32_t, PlayerStats>& stats,
+                  Scoreboard& scoreboard);
+  uint64_t append(JournalRecord& record);
+
+ public:
+  JournalStorage(const std::filesystem::path& dir, Logger& logger);
+  ~JournalStorage();
+
+  void load(std::unordered_map<uint32_t, Game>& active_games,
+            std::unordered_map<uint32_t, GameRef>& last_finished,
+            std::unordered_map<uint32_t, PlayerStats>& stats,
+            Scoreboard& scoreboard) override;
+  void createGame(const Game& game) override;
+  void addAttempt(const Game& game, const Attempt& attempt) override;
+  GameRef endGame(const Game& game, const Endings reason, const time_t& tstamp,
+                  const int used_time) override;
+  void saveScore(const LeaderboardEntry& entry, const time_t& tstamp) override;
+  void readFinishedGame(const uint32_t plid, const GameRef ref, Game& game) override;
+  void sync() override;
+  bool writeFailed(const uint32_t plid) override;
+  bool position(uint64_t& pos) override;
+  bool loadFrom(const uint64_t pos, std::unordered_map<uint32_t, Game>& active_games,
+                std::unordered_map<uint32_t, GameRef>& last_finished,
+                std::unordered_map<uint32_t, PlayerStats>& stats,
+                Scoreboard& scoreboard) override;
+  bool history(const uint32_t plid, const size_t offset, const size_t count,
+               std::vector<GameRef>& refs, size_t& total) override;
+};
+
+#endif
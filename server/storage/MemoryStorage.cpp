@@ -0,0 +1,49 @@
+#include "MemoryStorage.hpp"
+
+#include "../exceptions/ServerExceptions.hpp"
+
+/// @brief Nothing to load, the server always starts empty
+void MemoryStorage::load(std::unordered_map<uint32_t, Game>&,
+                         std::unordered_map<uint32_t, GameRef>&,
+                         std::unordered_map<uint32_t, PlayerStats>&, Scoreboard&) {}
+
+/// @brief Active games live in the GameStore only
+void MemoryStorage::createGame(const Game&) {}
+
+/// @brief Active games live in the GameStore only
+void MemoryStorage::addAttempt(const Game&, const Attempt&) {}
+
+/// @brief Keeps a copy of the finished game, replacing the player's previous one
+/// @param game Active game
+/// @param reason Ending reason (WIN, LOSS, QUIT, TIMEOUT)
+/// @param used_time Total used time for this game (seconds)
+/// @return Reference to the finished game
+GameRef MemoryStorage::endGame(const Game& game, const Endings reason, const time_t&,
+                               const int used_time) {
+  Game finished = game;
+  finished.ending = reason;
+  finished.usedTime = static_cast<uint16_t>(used_time);
+  finished.status = Game::Status::FIN;
+
+  std::lock_guard<std::mutex> lock(finishedMutex);
+  finishedGames[game.plid] = finished;
+  return nextRef++;
+}
+
+/// @brief Scores live in the GameStore's scoreboard only
+void MemoryStorage::saveScore(const LeaderboardEntry&, const time_t&) {}
+
+/// @brief Returns the last finished game of a player
+/// @param plid Player ID
+/// @param game Will store the finished game
+void MemoryStorage::readFinishedGame(const uint32_t plid, const GameRef, Game& game) {
+  std::lock_guard<std::mutex> lock(finishedMutex);
+  auto it = finishedGames.find(plid);
+  if (it == finishedGames.end()) {
+    throw DBFilesystemError();
+  }
+  game = it->second;
+}
+
+/// @brief Nothing to flush
+void MemoryStorage::sync() {}
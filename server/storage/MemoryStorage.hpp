@@ -0,0 +1,32 @@
+#ifndef SERVER_MEMORY_STORAGE_HPP
+#define SERVER_MEMORY_STORAGE_HPP
+
+#include <mutex>
+
+#include "Storage.hpp"
+
+/// Keeps nothing on disk. It only holds the last finished game of each player so STR
+/// works. Everything is lost when the server stops. Useful to measure request costs
+/// without storage
+class MemoryStorage : public Storage {
+ private:
+  std::mutex finishedMutex;
+  std::unordered_map<uint32_t, Game> finishedGames;
+  GameRef nextRef = 1;
+
+ public:
+  void load(std::unordered_map<uint32_t, Game>& active_games,
+            std::unordered_map<uint32_t, GameRef>& last_finished,
+            std::unordered_map<uint32_t, PlayerStats>& stats,
+            Scoreboard& scoreboard) override;
+  void createGame(const Game& game) override;
+  void addAttempt(const Game& game, const Attempt& attempt) override;
+  GameRef endGame(const Game& game, const Endings reason, const time_t& tstamp,
+                  const int used_time) override;
+  void saveScore(const LeaderboardEntry& entry, const time_t& tstamp) override;
+  void readFinishedGame(const uint32_t plid, const GameRef ref, Game& game) override;
+  void sync() override;
+  bool persists() const override { return false; }
+};
+
+#endif
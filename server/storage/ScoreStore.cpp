@@ -0,0 +1,205 @@
+#include "ScoreStore.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+
+#include "../../common/constants.hpp"
+#include "../exceptions/ServerExceptions.hpp"
+#include "../utils/crc32.hpp"
+
+namespace fs = std::filesystem;
+
+/// @brief Computes the checksum of a record (every byte before the checksum field)
+static uint32_t recordChecksum(const ScoreRecord& record) {
+  return crc32(reinterpret_cast<const unsigned char*>(&record),
+               offsetof(ScoreRecord, checksum));
+}
+
+/// @brief Opens (or creates) the store, maps it and indexes its valid records
+/// @param path Score store file path
+ScoreStore::ScoreStore(const fs::path& path) : path(path) {
+  fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd == -1) {
+    throw DBFilesystemError();
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    close(fd);
+    throw DBFilesystemError();
+  }
+  map(std::max<size_t>(static_cast<size_t>(st.st_size) / sizeof(ScoreRecord),
+                       SCORE_STORE_GROW_RECORDS));
+
+  while (count < capacity && records[count].magic == SCORE_RECORD_MAGIC &&
+         records[count].checksum == recordChecksum(records[count])) {
+    count++;
+  }
+  syncedCount = count;
+
+  bestOf.reserve(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    indexRecord(i);
+  }
+}
+
+/// @brief Unmaps and closes the store
+ScoreStore::~ScoreStore() {
+  if (records != nullptr) {
+    munmap(const_cast<ScoreRecord*>(records), capacity * sizeof(ScoreRecord));
+  }
+  if (fd != -1) {
+    close(fd);
+  }
+}
+
+/// @brief Grows the file to hold a given number of records (if needed) and maps all of
+/// it. The store lock must be held exclusively
+/// @param new_capacity Number of records
+void ScoreStore::map(const size_t new_capacity) {
+  if (posix_fallocate(fd, 0, new_capacity * sizeof(ScoreRecord)) != 0) {
+    throw DBFilesystemError();
+  }
+
+  void* mapping = mmap(nullptr, new_capacity * sizeof(ScoreRecord), PROT_READ, MAP_SHARED,
+                       fd, 0);
+  if (mapping == MAP_FAILED) {
+    throw DBFilesystemError();
+  }
+
+  if (records != nullptr) {
+    munmap(const_cast<ScoreRecord*>(records), capacity * sizeof(ScoreRecord));
+  }
+  records = static_cast<const ScoreRecord*>(mapping);
+  capacity = new_capacity;
+}
+
+/// @brief Leaderboard ordering of two records (see `LeaderboardEntry::isBetterThan`)
+bool ScoreStore::isBetter(const uint32_t a, const uint32_t b) const {
+  if (records[a].score != records[b].score) {
+    return records[a].score > records[b].score;
+  }
+  return records[a].plid > records[b].plid;
+}
+
+/// @brief Sort key of a record in the index, matching `isBetter`
+std::pair<int32_t, uint32_t> ScoreStore::rankOf(const uint32_t idx) const {
+  return {records[idx].score, records[idx].plid};
+}
+
+/// @brief Adds a new record to the sorted index and to its player's best. Ties keep the
+/// older record first. The store lock must be held exclusively
+/// @param idx Record index
+void ScoreStore::indexRecord(const uint32_t idx) {
+  sorted.emplace(rankOf(idx), idx);
+
+  auto [it, inserted] = bestOf.try_emplace(records[idx].plid, idx);
+  if (!inserted && isBetter(idx, it->second)) it->second = idx;
+}
+
+/// @brief Builds the leaderboard entry of a record
+LeaderboardEntry ScoreStore::toEntry(const uint32_t idx) const {
+  const ScoreRecord& record = records[idx];
+  return LeaderboardEntry(record.score, plidToStr(record.plid), unpackCode(record.key),
+                          record.used_atts, static_cast<GameMode>(record.mode));
+}
+
+/// @brief Appends a score, growing the file by `SCORE_STORE_GROW_RECORDS` when full
+/// @param entry Score entry
+/// @param tstamp Timestamp of win
+void ScoreStore::append(const LeaderboardEntry& entry, const time_t& tstamp) {
+  ScoreRecord record{};
+  record.magic = SCORE_RECORD_MAGIC;
+  record.score = entry.score;
+  record.plid = strToPlid(entry.plid);
+  packCode(entry.key, record.key);
+  record.used_atts = static_cast<uint8_t>(entry.used_atts);
+  record.mode = static_cast<uint8_t>(entry.mode);
+  record.tstamp = tstamp;
+  record.checksum = recordChecksum(record);
+
+  std::unique_lock<std::shared_mutex> lock(storeMutex);
+  if (count == capacity) {
+    map(capacity + SCORE_STORE_GROW_RECORDS);
+  }
+
+  // Written through the file, the shared mapping sees it right away
+  if (pwrite(fd, &record, sizeof(record), static_cast<off_t>(count * sizeof(record))) !=
+      sizeof(record)) {
+    throw DBFilesystemError();
+  }
+  indexRecord(static_cast<uint32_t>(count++));
+}
+
+/// @brief Returns the number of scores in the store
+size_t ScoreStore::size() {
+  std::shared_lock<std::shared_mutex> lock(storeMutex);
+  return count;
+}
+
+/// @brief Returns the best scores, best first
+/// @param n Maximum number of scores
+std::vector<LeaderboardEntry> ScoreStore::top(const size_t n) {
+  std::shared_lock<std::shared_mutex> lock(storeMutex);
+  std::vector<LeaderboardEntry> entries;
+
+  for (auto it = sorted.begin(); it != sorted.end() && entries.size() < n; ++it) {
+    entries.push_back(toEntry(it->second));
+  }
+  return entries;
+}
+
+/// @brief Returns the best score of a player
+/// @param plid Player ID
+/// @param entry Will store the player's best score
+/// @return `false` if the player has never won
+bool ScoreStore::playerBest(const uint32_t plid, LeaderboardEntry& entry) {
+  std::shared_lock<std::shared_mutex> lock(storeMutex);
+  auto it = bestOf.find(plid);
+  if (it == bestOf.end()) {
+    return false;
+  }
+
+  entry = toEntry(it->second);
+  return true;
+}
+
+/// @brief Returns the scores within a range, best first
+/// @param min_score Lowest score (inclusive)
+/// @param max_score Highest score (inclusive)
+/// @param limit Maximum number of scores
+std::vector<LeaderboardEntry> ScoreStore::range(const int min_score, const int max_score,
+                                                const size_t limit) {
+  std::shared_lock<std::shared_mutex> lock(storeMutex);
+  std::vector<LeaderboardEntry> entries;
+
+  auto it = sorted.lower_bound({max_score, UINT32_MAX});
+  for (; it != sorted.end() && entries.size() < limit; ++it) {
+    if (it->first.first < min_score) break;
+    entries.push_back(toEntry(it->second));
+  }
+  return entries;
+}
+
+/// @brief Flushes the records appended since the last sync
+void ScoreStore::sync() {
+  size_t target;
+  {
+    std::shared_lock<std::shared_mutex> lock(storeMutex);
+    target = count;
+    if (syncedCount == target) return;
+  }
+
+  if (fdatasync(fd) == -1) {
+    throw DBFilesystemError();
+  }
+
+  std::unique_lock<std::shared_mutex> lock(storeMutex);
+  syncedCount = std::max(syncedCount, target);
+}
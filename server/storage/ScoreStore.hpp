@@ -0,0 +1,70 @@
+#ifndef SERVER_SCORE_STORE_HPP
+#define SERVER_SCORE_STORE_HPP
+
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../Game.hpp"
+
+#define SCORE_RECORD_MAGIC 0x53434f52  // "ROCS"
+
+/// Fixed-size score record. Unwritten (zeroed) or torn records fail the magic or checksum
+/// checks, which marks the end of the store
+struct ScoreRecord {
+  uint32_t magic;
+  int32_t score;
+  uint32_t plid;
+  Code key;
+  uint8_t used_atts;
+  uint8_t mode;
+  int64_t tstamp;
+  uint32_t checksum;  // CRC32 of every byte before this field
+  uint32_t reserved;
+};
+
+static_assert(sizeof(ScoreRecord) == 32, "Score records must have a fixed on-disk size");
+
+/// Every score ever made, as fixed-size records appended to a single preallocated file
+/// that the server keeps memory-mapped. A sorted index of the records (best first) and
+/// the best record of each player are kept in memory, so queries never touch the disk
+class ScoreStore {
+ private:
+  std::filesystem::path path;
+  int fd = -1;
+  const ScoreRecord* records = nullptr;  // Read-only mapping of the whole file
+  size_t capacity = 0;                   // Records the file (and mapping) can hold
+  size_t count = 0;                      // Valid records
+  size_t syncedCount = 0;                // Records known to be durable
+
+  // Record indexes by (score, plid), best first. Equal keys keep insertion order
+  std::multimap<std::pair<int32_t, uint32_t>, uint32_t, std::greater<>> sorted;
+  std::unordered_map<uint32_t, uint32_t> bestOf;  // Best record of each player
+  std::shared_mutex storeMutex;
+
+  void map(const size_t new_capacity);
+  void indexRecord(const uint32_t idx);
+  bool isBetter(const uint32_t a, const uint32_t b) const;
+  std::pair<int32_t, uint32_t> rankOf(const uint32_t idx) const;
+  LeaderboardEntry toEntry(const uint32_t idx) const;
+
+ public:
+  ScoreStore(const std::filesystem::path& path);
+  ~ScoreStore();
+
+  void append(const LeaderboardEntry& entry, const time_t& tstamp);
+  size_t size();
+  std::vector<LeaderboardEntry> top(const size_t n);
+  bool playerBest(const uint32_t plid, LeaderboardEntry& entry);
+  std::vector<LeaderboardEntry> range(const int min_score, const int max_score,
+                                      const size_t limit);
+  void sync();
+};
+
+#endif
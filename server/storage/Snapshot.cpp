@@ -0,0 +1,189 @@
+#include "Snapshot.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+#include "../exceptions/ServerExceptions.hpp"
+#include "../utils/crc32.hpp"
+
+namespace fs = std::filesystem;
+
+// Games are stored as their in-memory representation
+static_assert(std::is_trivially_copyable_v<Game>, "Games must be trivially copyable");
+static_assert(std::is_trivially_copyable_v<PlayerStats>,
+              "Player stats must be trivially copyable");
+
+/// @brief Appends the raw bytes of an object to a buffer
+template <typename T>
+static void put(std::string& buffer, const T& value) {
+  buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/// @brief Writes a whole buffer to a file descriptor
+/// @return `false` on failure
+static bool writeAll(const int fd, const std::string& buffer) {
+  size_t written = 0;
+  while (written < buffer.size()) {
+    ssize_t wr = write(fd, buffer.data() + written, buffer.size() - written);
+    if (wr < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    written += static_cast<size_t>(wr);
+  }
+  return true;
+}
+
+/// @brief Atomically replaces the snapshot file. It is fully written and flushed under a
+/// temporary name before being renamed over the previous one
+/// @param path Snapshot file path
+/// @param snapshot State to write
+void writeSnapshot(const fs::path& path, const Snapshot& snapshot) {
+  std::string body;
+  body.reserve(snapshot.activeGames.size() * sizeof(Game) +
+               snapshot.lastFinished.size() * sizeof(SnapshotFinished) +
+               snapshot.stats.size() * sizeof(SnapshotStats) +
+               snapshot.scores.size() * sizeof(SnapshotScore));
+
+  for (const Game& game : snapshot.activeGames) {
+    put(body, game);
+  }
+  for (const auto& [plid, ref] : snapshot.lastFinished) {
+    SnapshotFinished finished{};
+    finished.plid = plid;
+    finished.ref = ref;
+    put(body, finished);
+  }
+  for (const auto& [plid, totals] : snapshot.stats) {
+    SnapshotStats stats{};
+    stats.plid = plid;
+    stats.stats = totals;
+    put(body, stats);
+  }
+  for (const LeaderboardEntry& entry : snapshot.scores) {
+    SnapshotScore score{};
+    score.score = entry.score;
+    score.plid = strToPlid(entry.plid);
+    packCode(entry.key, score.key);
+    score.used_atts = static_cast<uint8_t>(entry.used_atts);
+    score.mode = static_cast<uint8_t>(entry.mode);
+    put(body, score);
+  }
+
+  SnapshotHeader header{};
+  header.magic = SNAPSHOT_MAGIC;
+  header.checksum =
+      crc32(reinterpret_cast<const unsigned char*>(body.data()), body.size());
+  header.version = SNAPSHOT_VERSION;
+  header.storage = static_cast<uint8_t>(snapshot.storage);
+  header.position = snapshot.position;
+  header.n_games = snapshot.activeGames.size();
+  header.n_finished = snapshot.lastFinished.size();
+  header.n_stats = snapshot.stats.size();
+  header.n_scores = snapshot.scores.size();
+
+  std::string header_buffer;
+  put(header_buffer, header);
+
+  fs::path tmp_path = path;
+  tmp_path += ".tmp";
+
+  int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd == -1) {
+    throw DBFilesystemError();
+  }
+
+  bool ok = writeAll(fd, header_buffer) && writeAll(fd, body) && fsync(fd) == 0;
+  close(fd);
+
+  int dir_fd = -1;
+  if (ok && rename(tmp_path.c_str(), path.c_str()) == 0) {
+    // The rename itself must survive a crash too
+    dir_fd = open(path.parent_path().c_str(), O_RDONLY);
+    ok = dir_fd != -1 && fsync(dir_fd) == 0;
+  } else {
+    ok = false;
+  }
+
+  if (dir_fd != -1) close(dir_fd);
+  if (!ok) {
+    unlink(tmp_path.c_str());
+    throw DBFilesystemError();
+  }
+}
+
+/// @brief Reads and validates a snapshot file
+/// @param path Snapshot file path
+/// @param snapshot Will store the snapshot
+/// @return `false` if the file is missing, truncated, corrupted or of another version
+bool readSnapshot(const fs::path& path, Snapshot& snapshot) {
+  std::ifstream file(path, std::ios::binary);
+  SnapshotHeader header;
+
+  if (!file.is_open() || !file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+      header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION) {
+    return false;
+  }
+
+  std::error_code err;
+  uintmax_t body_size = fs::file_size(path, err) - sizeof(header);
+  if (err || header.n_games > body_size / sizeof(Game) ||
+      header.n_finished > body_size / sizeof(SnapshotFinished) ||
+      header.n_stats > body_size / sizeof(SnapshotStats) ||
+      header.n_scores > body_size / sizeof(SnapshotScore) ||
+      body_size != header.n_games * sizeof(Game) +
+                       header.n_finished * sizeof(SnapshotFinished) +
+                       header.n_stats * sizeof(SnapshotStats) +
+                       header.n_scores * sizeof(SnapshotScore)) {
+    return false;
+  }
+
+  std::string body(body_size, '\0');
+  if (!file.read(body.data(), static_cast<std::streamsize>(body_size)) ||
+      header.checksum !=
+          crc32(reinterpret_cast<const unsigned char*>(body.data()), body.size())) {
+    return false;
+  }
+
+  const char* cursor = body.data();
+  snapshot.storage = static_cast<StorageType>(header.storage);
+  snapshot.position = header.position;
+
+  snapshot.activeGames.resize(header.n_games);
+  for (Game& game : snapshot.activeGames) {
+    std::memcpy(&game, cursor, sizeof(Game));
+    cursor += sizeof(Game);
+  }
+
+  snapshot.lastFinished.reserve(header.n_finished);
+  for (uint64_t i = 0; i < header.n_finished; ++i) {
+    SnapshotFinished finished;
+    std::memcpy(&finished, cursor, sizeof(finished));
+    cursor += sizeof(finished);
+    snapshot.lastFinished.emplace_back(finished.plid, finished.ref);
+  }
+
+  snapshot.stats.reserve(header.n_stats);
+  for (uint64_t i = 0; i < header.n_stats; ++i) {
+    SnapshotStats stats;
+    std::memcpy(&stats, cursor, sizeof(stats));
+    cursor += sizeof(stats);
+    snapshot.stats.emplace_back(stats.plid, stats.stats);
+  }
+
+  snapshot.scores.reserve(header.n_scores);
+  for (uint64_t i = 0; i < header.n_scores; ++i) {
+    SnapshotScore score;
+    std::memcpy(&score, cursor, sizeof(score));
+    cursor += sizeof(score);
+    snapshot.scores.emplace_back(score.score, plidToStr(score.plid),
+                                 unpackCode(score.key), score.used_atts,
+                                 static_cast<GameMode>(score.mode));
+  }
+
+  return true;
+}
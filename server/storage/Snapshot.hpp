@@ -0,0 +1,60 @@
+#ifndef SERVER_SNAPSHOT_HPP
+#define SERVER_SNAPSHOT_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <utility>
+#include <vector>
+
+#include "Storage.hpp"
+
+#define SNAPSHOT_MAGIC 0x50534d47  // "GMSP"
+#define SNAPSHOT_VERSION 2
+
+/// Resident state of the GameStore as of a position of the storage backend's log
+struct Snapshot {
+  StorageType storage;
+  uint64_t position;
+  std::vector<Game> activeGames;
+  std::vector<std::pair<uint32_t, GameRef>> lastFinished;
+  std::vector<std::pair<uint32_t, PlayerStats>> stats;
+  std::vector<LeaderboardEntry> scores;
+};
+
+struct SnapshotHeader {
+  uint32_t magic;
+  uint32_t checksum;  // CRC32 of the body
+  uint8_t version;
+  uint8_t storage;
+  uint8_t reserved[6];
+  uint64_t position;
+  uint64_t n_games;
+  uint64_t n_finished;
+  uint64_t n_stats;
+  uint64_t n_scores;
+};
+
+struct SnapshotFinished {
+  uint32_t plid;
+  uint32_t reserved;
+  uint64_t ref;
+};
+
+struct SnapshotStats {
+  uint32_t plid;
+  PlayerStats stats;
+};
+
+struct SnapshotScore {
+  int32_t score;
+  uint32_t plid;
+  Code key;
+  uint8_t used_atts;
+  uint8_t mode;
+  uint32_t reserved;
+};
+
+void writeSnapshot(const std::filesystem::path& path, const Snapshot& snapshot);
+bool readSnapshot(const std::filesystem::path& path, Snapshot& snapshot);
+
+#endif
@@ -0,0 +1,50 @@
+#include "Storage.hpp"
+
+#include "../../common/exceptions/ConfigExceptions.hpp"
+#include "JournalStorage.hpp"
+#include "MemoryStorage.hpp"
+#include "TextStorage.hpp"
+
+/// @brief Returns the StorageType given its name
+/// @param str Storage name (text | memory | journal)
+StorageType strToStorageType(const std::string& str) {
+  if (str == "text") {
+    return StorageType::TEXT;
+  } else if (str == "memory") {
+    return StorageType::MEMORY;
+  } else if (str == "journal") {
+    return StorageType::JOURNAL;
+  }
+  throw InvalidStorageException();
+}
+
+/// @brief Returns the name of a StorageType
+/// @param type Storage type
+std::string storageTypeToRepr(const StorageType type) {
+  switch (type) {
+    case StorageType::MEMORY:
+      return "memory";
+    case StorageType::JOURNAL:
+      return "journal";
+    case StorageType::TEXT:
+    default:
+      return "text";
+  }
+}
+
+/// @brief Creates the storage backend of the given type
+/// @param type Storage type
+/// @param dir Database directory
+/// @param logger Logger the backend reports failed writes to
+std::unique_ptr<Storage> createStorage(const StorageType type,
+                                       const std::filesystem::path& dir, Logger& logger) {
+  switch (type) {
+    case StorageType::MEMORY:
+      return std::make_unique<MemoryStorage>();
+    case StorageType::JOURNAL:
+      return std::make_unique<JournalStorage>(dir, logger);
+    case StorageType::TEXT:
+    default:
+      return std::make_unique<TextStorage>(dir, logger);
+  }
+}
@@ -0,0 +1,76 @@
+#ifndef SERVER_STORAGE_HPP
+#define SERVER_STORAGE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../../common/Logger.hpp"
+#include "../Game.hpp"
+#include "../Scoreboard.hpp"
+
+enum class StorageType { TEXT, MEMORY, JOURNAL };
+
+typedef uint64_t GameRef;  // Backend specific locator of a finished game
+
+StorageType strToStorageType(const std::string& str);
+std::string storageTypeToRepr(const StorageType type);
+
+/// Persistence backend used by the GameStore. The GameStore owns the resident state and
+/// the game logic, backends only persist events and read back what is not kept in memory
+class Storage {
+ public:
+  virtual ~Storage() = default;
+
+  virtual void load(std::unordered_map<uint32_t, Game>& active_games,
+                    std::unordered_map<uint32_t, GameRef>& last_finished,
+                    std::unordered_map<uint32_t, PlayerStats>& stats,
+                    Scoreboard& scoreboard) = 0;
+  virtual void createGame(const Game& game) = 0;
+  virtual void addAttempt(const Game& game, const Attempt& attempt) = 0;
+  virtual GameRef endGame(const Game& game, const Endings reason, const time_t& tstamp,
+                          const int used_time) = 0;
+  virtual void saveScore(const LeaderboardEntry& entry, const time_t& tstamp) = 0;
+  virtual void readFinishedGame(const uint32_t plid, const GameRef ref, Game& game) = 0;
+  virtual void sync() = 0;  // Makes every write issued so far durable
+  virtual bool persists() const { return true; }  // `false`: nothing is ever written
+
+  // Whether a write of the player failed since it was last asked, once the writes are
+  // flushed. Backends that write synchronously throw from the write itself instead
+  virtual bool writeFailed(const uint32_t plid) {
+    (void)plid;
+    return false;
+  }
+
+  // Snapshot support. `position` is the current end of the backend's change log and
+  // `loadFrom` rebuilds the resident state from a snapshot taken at that position by
+  // replaying only what was logged after it. Backends without a log return `false`
+  virtual bool position(uint64_t& pos) {
+    (void)pos;
+    return false;
+  }
+  virtual bool loadFrom(const uint64_t pos,
+                        std::unordered_map<uint32_t, Game>& active_games,
+                        std::unordered_map<uint32_t, GameRef>& last_finished,
+                        std::unordered_map<uint32_t, PlayerStats>& stats,
+                        Scoreboard& scoreboard) {
+    (void)pos, (void)active_games, (void)last_finished, (void)stats, (void)scoreboard;
+    return false;
+  }
+
+  // Finished games of a player, newest first, and how many there are in total. Backends
+  // that don't keep every finished game return `false`
+  virtual bool history(const uint32_t plid, const size_t offset, const size_t count,
+                       std::vector<GameRef>& refs, size_t& total) {
+    (void)plid, (void)offset, (void)count, (void)refs, (void)total;
+    return false;
+  }
+};
+
+std::unique_ptr<Storage> createStorage(const StorageType type,
+                                       const std::filesystem::path& dir, Logger& logger);
+
+#endif
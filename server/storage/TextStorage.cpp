@@ -0,0 +1,1115 @@
+#include "TextStorage.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+
+#include "../../common/constants.hpp"
+#include "../../common/utils.hpp"
+#include "../exceptions/GameExceptions.hpp"
+#include "../exceptions/ServerExceptions.hpp"
+#include "../utils/MappedFile.hpp"
+#include "../utils/scan.hpp"
+#include "Archive.hpp"
+#include "ColdGame.hpp"
+#include "ScoreStore.hpp"
+
+namespace fs = std::filesystem;
+
+/// @brief Initializes the required directories and opens the score store
+/// @param dir Database directory
+/// @param logger Logger the failed writes are reported to
+TextStorage::TextStorage(const fs::path& dir, Logger& logger)
+    : gamesDir(dir / "GAMES"),
+      scoresDir(dir / "SCORES"),
+      indexPath(dir / "GAMES" / "FINISHED.idx"),
+      historyIndex(dir / "HISTORY", 8),  // References are (tstamp << 8) | ending
+      writeQueue(
+          [this](std::vector<std::function<void()>>& batch, std::vector<bool>& failed) {
+            writeBatch(batch, failed);
+          },
+          logger) {
+  fs::create_directory(gamesDir);
+  fs::create_directory(scoresDir);
+
+  fs::path score_store_path = scoresDir / "SCORES.dat";
+  bool is_new = !fs::exists(score_store_path);
+  scoreStore = std::make_unique<ScoreStore>(score_store_path);
+  if (is_new) {
+    importScoreFiles();
+  }
+}
+
+/// @brief Carries out the queued operations and stops the compactor
+TextStorage::~TextStorage() {
+  writeQueue.stop();
+
+  {
+    std::lock_guard<std::mutex> lock(compactorMutex);
+    isStopping = true;
+  }
+  compactorCond.notify_all();
+
+  if (compactorThread.joinable()) {
+    compactorThread.join();
+  }
+}
+
+/// @brief Checks if a directory name is a PLID (a player directory)
+static bool isPlidName(const std::string& name) {
+  return name.size() == PLID_LEN && std::all_of(name.begin(), name.end(), ::isdigit);
+}
+
+/// @brief Returns the shard directory of a player (Ex: `GAMES/56/34/` for 123456). The
+/// last digits of PLIDs vary the most, so players spread evenly over the shards
+/// @param plid Player ID
+fs::path TextStorage::shardDir(const uint32_t plid) {
+  std::string plid_str = plidToStr(plid);
+  return gamesDir / plid_str.substr(4, 2) / plid_str.substr(2, 2);
+}
+
+/// @brief Creates the shard directory of a player, if missing
+/// @param plid Player ID
+/// @return Shard directory
+fs::path TextStorage::makeShardDir(const uint32_t plid) {
+  fs::path dir = shardDir(plid);
+  try {
+    if (fs::create_directories(dir)) {
+      markDirty(dir.parent_path());
+      markDirty(gamesDir);
+    }
+  } catch (const fs::filesystem_error& e) {
+    throw DBFilesystemError();
+  }
+  return dir;
+}
+
+/// @brief Returns the path of the active game file of a player
+/// @param plid Player ID
+fs::path TextStorage::activeGamePath(const uint32_t plid) {
+  return shardDir(plid) / ("GAME_" + plidToStr(plid) + ".txt");
+}
+
+/// @brief Returns the directory of the finished games of a player. While the migration
+/// runs, a directory still directly under `GAMES/` is moved into its shard first, so it
+/// is never used from both places. Concurrent moves are harmless: only one finds it
+/// @param plid Player ID
+fs::path TextStorage::playerDir(const uint32_t plid) {
+  fs::path dir = shardDir(plid) / plidToStr(plid);
+  if (!isMigrating) {
+    return dir;
+  }
+
+  fs::path old_dir = gamesDir / plidToStr(plid);
+  std::error_code err;
+  if (!fs::is_directory(old_dir, err)) {
+    return dir;
+  }
+
+  makeShardDir(plid);
+  fs::rename(old_dir, dir, err);
+  if (err && fs::is_directory(old_dir)) {
+    throw DBFilesystemError();
+  }
+
+  markDirty(gamesDir);
+  markDirty(dir.parent_path());
+  return dir;
+}
+
+/// @brief Lists the directory of every player, in the shards or still directly under
+/// `GAMES/`
+std::vector<fs::path> TextStorage::listPlayerDirs() {
+  std::vector<fs::path> dirs;
+  for (const auto& top : fs::directory_iterator(gamesDir)) {
+    if (!top.is_directory()) continue;
+
+    if (isPlidName(top.path().filename().string())) {
+      dirs.push_back(top.path());
+      continue;
+    }
+    for (const auto& shard : fs::directory_iterator(top.path())) {
+      if (!shard.is_directory()) continue;
+
+      for (const auto& entry : fs::directory_iterator(shard.path())) {
+        if (entry.is_directory()) dirs.push_back(entry.path());
+      }
+    }
+  }
+  return dirs;
+}
+
+/// @brief Moves the player directories left directly under `GAMES/` into their shards
+/// (compactor thread). Requests keep being served meanwhile, as every use of a player
+/// directory moves it first
+void TextStorage::migratePlayerDirs() {
+  try {
+    for (const auto& entry : fs::directory_iterator(gamesDir)) {
+      if (isStopping) return;
+
+      std::string name = entry.path().filename().string();
+      if (entry.is_directory() && isPlidName(name)) {
+        playerDir(strToPlid(name));
+      }
+    }
+    setMigrating(false);
+  } catch (const std::exception&) {
+    // Resumed on the next start
+  }
+}
+
+/// @brief Starts or ends the migration of the player directories. The marker file
+/// follows it, so a restart from a snapshot knows about it without listing `GAMES/`
+/// @param migrating Whether player directories are left directly under `GAMES/`
+void TextStorage::setMigrating(const bool migrating) {
+  fs::path marker = gamesDir / TEXT_MIGRATION_MARKER;
+  std::error_code err;
+  if (migrating) {
+    std::ofstream file(marker);
+    if (!file.is_open()) {
+      throw DBFilesystemError();
+    }
+  } else if (!fs::remove(marker, err)) {
+    isMigrating = false;
+    return;  // Not migrating (a marker that can't be removed only repeats the check)
+  }
+
+  markDirty(gamesDir);
+  isMigrating = migrating;
+}
+
+/// @brief Builds a finished game reference from its ending timestamp and reason
+static GameRef makeRef(const time_t tstamp, const Endings ending) {
+  return (static_cast<GameRef>(tstamp) << 8) | static_cast<GameRef>(ending);
+}
+
+/// @brief Rebuilds the reference of a finished game from its file name
+/// @param fname Finished game file name (YYYYMMDD_HHMMSS_E.txt)
+/// @param ref Will store the reference
+/// @return `false` if the name is not one of a finished game
+static bool nameToRef(const std::string& fname, GameRef& ref) {
+  if (fname.size() < 17) return false;
+
+  std::tm tm = {};
+  std::istringstream date_ss(fname);
+  date_ss >> std::get_time(&tm, TSTAMP_DATE_TIME_);
+  if (date_ss.fail()) return false;
+  tm.tm_isdst = -1;
+
+  try {
+    ref = makeRef(std::mktime(&tm), charToEnding(fname[16]));
+    return true;
+  } catch (const std::exception& e) {
+    return false;
+  }
+}
+
+/// @brief Returns the file name of a finished game (Ex: 20241216_191236_W.txt)
+/// @param ref Finished game reference
+std::string TextStorage::finishedGameName(const GameRef ref) {
+  time_t tstamp = static_cast<time_t>(ref >> 8);
+  Endings ending = static_cast<Endings>(ref & 0xff);
+
+  std::ostringstream fname;
+  formatTimestamp(fname, &tstamp, TSTAMP_DATE_TIME_);
+  fname << '_' << endingToRepr(ending)[0] << ".txt";
+  return fname.str();
+}
+
+/// @brief Registers a written file or directory to be flushed on the next sync
+/// @param path File or directory path
+void TextStorage::markDirty(const fs::path& path) {
+  std::lock_guard<std::mutex> lock(dirtyMutex);
+  dirtyPaths.insert(path.string());
+}
+
+/// @brief Loads the active games and, from the finished games index, the last finished
+/// game and totals of each player and the scoreboard. The index (and the history index)
+/// is built first if this data directory predates it, and compacted when most of its
+/// lines are outdated
+/// @param active_games Active games table
+/// @param last_finished Last finished game of each player
+/// @param stats Finished games totals of each player
+/// @param scoreboard Top scores index
+void TextStorage::load(std::unordered_map<uint32_t, Game>& active_games,
+                       std::unordered_map<uint32_t, GameRef>& last_finished,
+                       std::unordered_map<uint32_t, PlayerStats>& stats,
+                       Scoreboard& scoreboard) {
+  loadActiveGames(active_games);
+  if (!historyIndex.exists()) {
+    rebuildHistory();
+  }
+
+  size_t lines = 0;
+  std::vector<uint32_t> started;
+  if (!readIndex(0, last_finished, stats, scoreboard, lines, started)) {
+    rebuildIndex(last_finished, stats);
+    loadScores(scoreboard);
+    writeIndex(last_finished, stats, scoreboard);
+  } else if (lines > 3 * last_finished.size() + SCOREBOARD_MAX_ENTRIES) {
+    writeIndex(last_finished, stats, scoreboard);
+  }
+
+  openIndex();
+  startCompactor();
+}
+
+/// @brief Completes the state of a snapshot with the index lines appended after it.
+/// Active game files are appended to in place, so the ones of the snapshot's active
+/// games and of the games started after it are read again. No directory is listed
+/// @param pos Index size when the snapshot was taken
+/// @param active_games Active games table, as of the snapshot
+/// @param last_finished Last finished game of each player, as of the snapshot
+/// @param stats Finished games totals of each player, as of the snapshot
+/// @param scoreboard Top scores index, as of the snapshot
+/// @return `false` if the index no longer extends the snapshot's one
+bool TextStorage::loadFrom(const uint64_t pos,
+                           std::unordered_map<uint32_t, Game>& active_games,
+                           std::unordered_map<uint32_t, GameRef>& last_finished,
+                           std::unordered_map<uint32_t, PlayerStats>& stats,
+                           Scoreboard& scoreboard) {
+  if (!historyIndex.exists()) {
+    rebuildHistory();
+  }
+
+  size_t lines = 0;
+  std::vector<uint32_t> started;
+  if (pos == 0 || !readIndex(pos, last_finished, stats, scoreboard, lines, started)) {
+    return false;
+  }
+
+  isMigrating = fs::exists(gamesDir / TEXT_MIGRATION_MARKER);
+  reloadActiveGames(active_games, started);
+  openIndex();
+  startCompactor();
+  return true;
+}
+
+/// @brief Parses every active game file (GAME_<plid>.txt) into the active games table.
+/// Files directly under `GAMES/`, from before the shards, are moved into theirs, and
+/// player directories left there are handed to the background migration
+/// @param active_games Active games table
+void TextStorage::loadActiveGames(std::unordered_map<uint32_t, Game>& active_games) {
+  auto is_game_file = [](const fs::directory_entry& entry) {
+    return entry.is_regular_file() &&
+           entry.path().filename().string().rfind("GAME_", 0) == 0;
+  };
+
+  try {
+    bool migrating = false;
+    std::vector<fs::path> paths;
+    for (const auto& top : fs::directory_iterator(gamesDir)) {
+      if (is_game_file(top)) {
+        paths.push_back(top.path());
+      } else if (top.is_directory() && isPlidName(top.path().filename().string())) {
+        migrating = true;
+      } else if (top.is_directory()) {
+        for (const auto& shard : fs::directory_iterator(top.path())) {
+          if (!shard.is_directory()) continue;
+
+          for (const auto& entry : fs::directory_iterator(shard.path())) {
+            if (is_game_file(entry)) paths.push_back(entry.path());
+          }
+        }
+      }
+    }
+
+    std::string contents;
+    for (const fs::path& path : paths) {
+      if (!readSmallFile(path, contents)) {
+        throw DBFilesystemError();
+      }
+
+      Game game;
+      game.parseGame(contents);
+      game.status = Game::Status::ACT;
+      active_games[game.plid] = game;
+
+      if (path.parent_path() == gamesDir) {
+        makeShardDir(game.plid);
+        fs::rename(path, activeGamePath(game.plid));
+        markDirty(gamesDir);
+        markDirty(shardDir(game.plid));
+      }
+    }
+    setMigrating(migrating);
+  } catch (const std::exception& e) {
+    throw DBFilesystemError();
+  }
+}
+
+/// @brief Reads the active game files of the players whose game was active when the
+/// snapshot was taken or was started after it. A file no longer there is a game that
+/// has ended since
+/// @param active_games Active games table, as of the snapshot (replaced)
+/// @param started Players whose game started after the snapshot
+void TextStorage::reloadActiveGames(std::unordered_map<uint32_t, Game>& active_games,
+                                    const std::vector<uint32_t>& started) {
+  std::vector<uint32_t> plids = started;
+  for (const auto& [plid, game] : active_games) {
+    plids.push_back(plid);
+  }
+  std::sort(plids.begin(), plids.end());
+  plids.erase(std::unique(plids.begin(), plids.end()), plids.end());
+
+  active_games.clear();
+  try {
+    std::string contents;
+    for (const uint32_t plid : plids) {
+      if (!readSmallFile(activeGamePath(plid), contents)) {
+        if (errno == ENOENT) continue;
+        throw DBFilesystemError();
+      }
+
+      Game game;
+      game.parseGame(contents);
+      game.status = Game::Status::ACT;
+      active_games[game.plid] = game;
+    }
+  } catch (const std::exception& e) {
+    throw DBFilesystemError();
+  }
+}
+
+/// @brief Applies the lines of the finished games index from a given offset and adds
+/// the finished games missing from the history index to it
+/// @param offset Byte offset of the first line to apply (`0`: whole index)
+/// @param last_finished Last finished game of each player
+/// @param stats Finished games totals of each player
+/// @param scoreboard Top scores index
+/// @param lines Will store the number of applied lines
+/// @param started Will store the players whose game started, in index order
+/// @return `false` if the index is missing, of an older format or shorter than `offset`
+bool TextStorage::readIndex(const uint64_t offset,
+                            std::unordered_map<uint32_t, GameRef>& last_finished,
+                            std::unordered_map<uint32_t, PlayerStats>& stats,
+                            Scoreboard& scoreboard, size_t& lines,
+                            std::vector<uint32_t>& started) {
+  MappedFile index(indexPath);
+  std::string_view contents = index.view();
+  std::string_view line;
+
+  if (!index.isOpen() || !nextLine(contents, line) || line != TEXT_INDEX_HEADER) {
+    return false;
+  }
+  if (offset > 0) {
+    if (offset > index.view().size()) {
+      return false;
+    }
+    contents = index.view().substr(offset);
+  }
+
+  // Games finished after the history index was last synced are missing from it
+  std::unordered_map<uint32_t, std::vector<GameRef>> replayed;
+
+  lines = 0;
+  while (nextLine(contents, line)) {
+    uint32_t plid;
+
+    if (line.rfind("G ", 0) == 0) {
+      // G <plid>
+      line.remove_prefix(2);
+      if (nextNumber(line, plid)) started.push_back(plid);
+    } else if (line.rfind("S ", 0) == 0) {
+      // S <score> <plid> <key> <attempts> <mode>
+      LeaderboardEntry entry;
+      if (entry.parse(line.substr(2))) {
+        scoreboard.insert(entry);
+        stats[strToPlid(entry.plid)].addScore(entry.score);
+      }
+    } else if (line.rfind("P ", 0) == 0) {
+      // P <plid> <wins> <losses> <quits> <timeouts> <attempts> <best score>
+      PlayerStats totals;
+      line.remove_prefix(2);
+      bool ok = nextNumber(line, plid);
+      for (uint32_t& count : totals.endings) ok = ok && nextNumber(line, count);
+      ok = ok && nextNumber(line, totals.attempts) && nextNumber(line, totals.bestScore);
+      if (ok) stats[plid] = totals;
+    } else {
+      // <plid> <end timestamp> <ending> <attempts>
+      time_t tstamp;
+      char ending_char;
+      uint num_attempts;
+      if (nextNumber(line, plid) && nextNumber(line, tstamp) &&
+          nextChar(line, ending_char) && nextNumber(line, num_attempts)) {
+        Endings ending = charToEnding(ending_char);
+        last_finished[plid] = makeRef(tstamp, ending);
+        stats[plid].addGame(ending, num_attempts);
+        replayed[plid].push_back(last_finished[plid]);
+      }
+    }
+    lines++;
+  }
+
+  for (const auto& [plid, refs] : replayed) {
+    historyIndex.append(plid, refs);
+  }
+  return true;
+}
+
+/// @brief Builds the finished games index by scanning every player directory once. The
+/// totals of each player need every one of its games to be read
+/// @param last_finished Last finished game of each player
+/// @param stats Finished games totals of each player
+void TextStorage::rebuildIndex(std::unordered_map<uint32_t, GameRef>& last_finished,
+                               std::unordered_map<uint32_t, PlayerStats>& stats) {
+  try {
+    for (const fs::path& dir : listPlayerDirs()) {
+      // A game may be both archived and still in its file, if the compactor was
+      // interrupted before removing it
+      std::map<std::string, std::string> games;
+      for (auto& [fname, contents] : readArchive(dir)) {
+        games[fname] = std::move(contents);
+      }
+      for (const auto& entry : fs::directory_iterator(dir)) {
+        if (!entry.is_regular_file() || entry.path().extension() != ".txt") continue;
+
+        std::ifstream file(entry.path(), std::ios::binary);
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        games[entry.path().filename().string()] = contents.str();
+      }
+
+      uint32_t plid = strToPlid(dir.filename().string());
+      std::string last;
+      for (const auto& [fname, contents] : games) {
+        Game game;
+        if (fname.size() < 17 || !parseStoredGame(contents, game)) continue;
+
+        // YYYYMMDD_HHMMSS_E.txt
+        stats[plid].addGame(charToEnding(fname[16]), game.numAttempts);
+        last = std::max(last, fname);
+      }
+
+      GameRef ref;
+      if (!nameToRef(last, ref)) continue;
+
+      last_finished[plid] = ref;
+
+      LeaderboardEntry best;
+      if (scoreStore->playerBest(plid, best)) {
+        stats[plid].addScore(best.score);
+      }
+    }
+  } catch (const std::exception& e) {
+    throw DBFilesystemError();
+  }
+}
+
+/// @brief Builds the history index from the names of the finished game files and
+/// archived games of every player. Names start with the ending date, so they sort in
+/// the order the games finished
+void TextStorage::rebuildHistory() {
+  std::unordered_map<uint32_t, std::vector<GameRef>> history;
+
+  try {
+    for (const fs::path& dir : listPlayerDirs()) {
+      std::vector<std::string> names = listArchive(dir);
+      for (const auto& entry : fs::directory_iterator(dir)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".txt") {
+          names.push_back(entry.path().filename().string());
+        }
+      }
+
+      // A game may be both archived and still in its file
+      std::sort(names.begin(), names.end());
+      names.erase(std::unique(names.begin(), names.end()), names.end());
+
+      std::vector<GameRef>& refs = history[strToPlid(dir.filename().string())];
+      for (const std::string& fname : names) {
+        GameRef ref;
+        if (nameToRef(fname, ref)) refs.push_back(ref);
+      }
+    }
+  } catch (const std::exception& e) {
+    throw DBFilesystemError();
+  }
+
+  historyIndex.rebuild(history);
+}
+
+/// @brief Atomically replaces the finished games index with two lines per player (last
+/// finished game and totals) and one line per top score
+/// @param last_finished Last finished game of each player
+/// @param stats Finished games totals of each player
+/// @param scoreboard Top scores index
+void TextStorage::writeIndex(const std::unordered_map<uint32_t, GameRef>& last_finished,
+                             const std::unordered_map<uint32_t, PlayerStats>& stats,
+                             Scoreboard& scoreboard) {
+  fs::path tmp_path = indexPath;
+  tmp_path += ".tmp";
+
+  std::ofstream tmp(tmp_path, std::ios::trunc);
+  if (!tmp.is_open()) {
+    throw DBFilesystemError();
+  }
+
+  uint64_t version;
+  tmp << TEXT_INDEX_HEADER << '\n';
+  for (const auto& [plid, ref] : last_finished) {
+    // The totals line replaces what the finished game line adds to them
+    tmp << plidToStr(plid) << ' ' << (ref >> 8) << ' '
+        << endingToRepr(static_cast<Endings>(ref & 0xff))[0] << " 0\n";
+
+    auto it = stats.find(plid);
+    if (it == stats.end()) continue;
+
+    const PlayerStats& totals = it->second;
+    tmp << "P " << plidToStr(plid);
+    for (uint32_t count : totals.endings) tmp << ' ' << count;
+    tmp << ' ' << totals.attempts << ' ' << totals.bestScore << '\n';
+  }
+  for (const LeaderboardEntry& entry : scoreboard.top(version)) {
+    tmp << "S " << entry.serialize();
+  }
+  tmp.close();
+
+  try {
+    fs::rename(tmp_path, indexPath);
+  } catch (const fs::filesystem_error& e) {
+    throw DBFilesystemError();
+  }
+  markDirty(indexPath);
+  markDirty(gamesDir);
+}
+
+/// @brief Opens the finished games index for appending
+void TextStorage::openIndex() {
+  std::lock_guard<std::mutex> lock(indexMutex);
+  indexFile.open(indexPath, std::ios::app);
+
+  std::error_code err;
+  indexSize = fs::file_size(indexPath, err);
+  if (!indexFile.is_open() || err) {
+    throw DBFilesystemError();
+  }
+}
+
+/// @brief Appends a line to the finished games index (writer thread). The index is
+/// flushed at the end of the batch
+/// @param line Index line, newline terminated
+void TextStorage::appendIndex(const std::string& line) {
+  indexFile << line;
+  if (!indexFile) {
+    throw DBFilesystemError();
+  }
+  markDirty(indexPath);
+}
+
+/// @brief Accounts for an index line about to be queued, so the index position always
+/// matches the resident state
+/// @param line Index line, newline terminated
+void TextStorage::reserveIndex(const std::string& line) {
+  std::lock_guard<std::mutex> lock(indexMutex);
+  indexSize += line.size();
+}
+
+/// @brief Carries out a batch of queued operations (writer thread). A failed operation
+/// doesn't keep the next ones from being carried out
+/// @param batch Operations in the order they were queued
+/// @param failed Will flag the operations that failed
+void TextStorage::writeBatch(std::vector<std::function<void()>>& batch,
+                             std::vector<bool>& failed) {
+  for (size_t i = 0; i < batch.size(); ++i) {
+    try {
+      batch[i]();
+    } catch (const std::exception& e) {
+      failed[i] = true;
+    }
+  }
+
+  // The lost index lines may belong to any operation of the batch
+  indexFile.flush();
+  if (!indexFile) {
+    indexFile.clear();
+    throw DBFilesystemError();
+  }
+}
+
+/// @brief Queues the creation of the active game file, logged to the index
+/// @param game New game
+void TextStorage::createGame(const Game& game) {
+  std::string line = "G " + plidToStr(game.plid) + '\n';
+  reserveIndex(line);
+
+  writeQueue.push(game.plid, "new game", [this, game, line] {
+    writeGame(game);
+    appendIndex(line);
+  });
+}
+
+/// @brief Queues an attempt to be appended to the active game file
+/// @param game Active game
+/// @param attempt New attempt
+void TextStorage::addAttempt(const Game& game, const Attempt& attempt) {
+  writeQueue.push(game.plid, "attempt",
+                  [this, game, attempt] { writeAttempt(game, attempt); });
+}
+
+/// @brief Queues the ending of a game. Its reference only depends on the ending, so it
+/// is known before the game file is moved
+/// @param game Active game
+/// @param reason Ending reason (WIN, LOSS, QUIT, TIMEOUT)
+/// @param tstamp Ending timestamp
+/// @param used_time Total used time for this game (seconds)
+/// @return Reference to the finished game
+GameRef TextStorage::endGame(const Game& game, const Endings reason, const time_t& tstamp,
+                             const int used_time) {
+  std::ostringstream index_line;
+  index_line << plidToStr(game.plid) << ' ' << tstamp << ' ' << endingToRepr(reason)[0]
+             << ' ' << +game.numAttempts << '\n';
+
+  reserveIndex(index_line.str());
+  time_t end = tstamp;
+  writeQueue.push(game.plid, "game ending",
+                  [this, game, reason, end, used_time, line = index_line.str()] {
+                    writeEnding(game, reason, end, used_time, line);
+                  });
+  return makeRef(tstamp, reason);
+}
+
+/// @brief Creates the active game file with the game's header (writer thread)
+/// @param game New game
+void TextStorage::writeGame(const Game& game) {
+  makeShardDir(game.plid);
+  fs::path game_path = activeGamePath(game.plid);
+  std::ofstream file(game_path, std::ios::trunc);
+  if (!file.is_open()) {
+    throw DBFilesystemError();
+  }
+
+  try {
+    file << game.serializeHeader();
+    file.close();
+  } catch (const std::exception& e) {
+    throw DBFilesystemError();
+  }
+
+  markDirty(game_path);
+  markDirty(game_path.parent_path());
+}
+
+/// @brief Appends an attempt to the active game file (writer thread)
+/// @param game Active game
+/// @param attempt New attempt
+void TextStorage::writeAttempt(const Game& game, const Attempt& attempt) {
+  fs::path game_path = activeGamePath(game.plid);
+  std::ofstream file(game_path, std::ios::app);
+  if (!file.is_open()) {
+    throw DBFilesystemError();
+  }
+
+  try {
+    file << attempt.serialize();
+    file.close();
+  } catch (const std::exception& e) {
+    throw DBFilesystemError();
+  }
+
+  markDirty(game_path);
+}
+
+/// @brief Appends the ending to the active game file, moves it to the player's directory
+/// and records it in the finished games and history indexes (writer thread)
+/// @param game Active game
+/// @param reason Ending reason (WIN, LOSS, QUIT, TIMEOUT)
+/// @param tstamp Ending timestamp
+/// @param used_time Total used time for this game (seconds)
+/// @param index_line Finished games index line, already accounted for
+void TextStorage::writeEnding(const Game& game, const Endings reason,
+                              const time_t tstamp, const int used_time,
+                              const std::string& index_line) {
+  fs::path game_path = activeGamePath(game.plid);
+
+  std::ofstream file(game_path, std::ios::app);
+  if (!file.is_open()) {
+    throw DBFilesystemError();
+  }
+
+  std::ostringstream ss;
+  formatTimestamp(ss, &tstamp, TSTAMP_DATE_TIME_PRETTY);
+  ss << ' ' << used_time << ' ' << endingToRepr(reason)[0] << '\n';
+
+  file << ss.str();
+  file.close();
+
+  GameRef ref = makeRef(tstamp, reason);
+  fs::path finished_path = playerDir(game.plid) / finishedGameName(ref);
+
+  try {
+    // Create PLID directory and store the finished game there
+    fs::create_directories(finished_path.parent_path());
+
+    fs::rename(game_path, finished_path);
+  } catch (const fs::filesystem_error& e) {
+    throw DBFilesystemError();
+  }
+
+  appendIndex(index_line);
+  historyIndex.append(game.plid, {ref});
+  addCompactCandidate(game.plid, finished_path.filename().string());
+
+  markDirty(finished_path);
+  markDirty(finished_path.parent_path());
+  markDirty(game_path.parent_path());
+}
+
+/// @brief Queues a score to be saved to the score store and logged to the index
+/// @param entry Score entry
+/// @param tstamp Timestamp of win
+void TextStorage::saveScore(const LeaderboardEntry& entry, const time_t& tstamp) {
+  std::string line = "S " + entry.serialize();
+  reserveIndex(line);
+
+  time_t win = tstamp;
+  writeQueue.push(strToPlid(entry.plid), "score", [this, entry, win, line] {
+    scoreStore->append(entry, win);
+    appendIndex(line);
+  });
+}
+
+/// @brief Parses a finished game of a player, from its file or from the player's
+/// archive. Queued operations are carried out first, as the game may be one of them
+/// @param plid Player ID
+/// @param ref Finished game reference
+/// @param game Will store the parsed game
+void TextStorage::readFinishedGame(const uint32_t plid, const GameRef ref,
+                                   Game& game) {
+  writeQueue.flush();
+
+  fs::path player_dir = playerDir(plid);
+  std::string fname = finishedGameName(ref);
+  std::string contents;
+
+  try {
+    if (readSmallFile(player_dir / fname, contents)) {
+      game.parseGame(contents);
+      return;
+    }
+
+    // Archived by the compactor (which removes the file only once it is archived)
+    ArchiveEntry entry;
+    if (!findArchived(plid, player_dir, fname, entry)) {
+      throw DBFilesystemError();
+    }
+    readFromArchive(player_dir, entry, contents);
+    if (!parseStoredGame(contents, game)) {
+      throw DBFilesystemError();
+    }
+  } catch (const std::exception& e) {
+    throw DBFilesystemError();
+  }
+}
+
+/// @brief Looks an archived game up in the player's archive index, loading the index
+/// on the player's first archived read
+/// @param plid Player ID
+/// @param dir Player directory
+/// @param name File name the game had before being archived
+/// @param entry Will store the location of the game in the archive
+/// @return `false` if the game is not archived
+bool TextStorage::findArchived(const uint32_t plid, const fs::path& dir,
+                               const std::string& name, ArchiveEntry& entry) {
+  std::lock_guard<std::mutex> lock(archiveMutex);
+  auto it = archiveIndexes.find(plid);
+  if (it == archiveIndexes.end()) {
+    ArchiveIndex index;
+    if (!loadArchiveIndex(dir, index)) {
+      return false;
+    }
+    it = archiveIndexes.emplace(plid, std::move(index)).first;
+  }
+
+  auto found = it->second.find(name);
+  if (found == it->second.end()) {
+    return false;
+  }
+  entry = found->second;
+  return true;
+}
+
+/// @brief Parses a finished game as stored in a game file or in an archive
+/// @param contents Game file contents or cold encoded game
+/// @param game Will store the game
+/// @return `false` if the game could not be parsed
+bool TextStorage::parseStoredGame(const std::string& contents, Game& game) {
+  if (isColdGame(contents)) {
+    return decodeColdGame(contents, game);
+  }
+
+  // Game file, also kept as is in archives when the compactor could not parse it
+  try {
+    game.parseGame(contents);
+    return true;
+  } catch (const std::exception& e) {
+    return false;
+  }
+}
+
+/// @brief Inserts the best scores of the score store into the scoreboard
+/// @param scoreboard Top scores index
+void TextStorage::loadScores(Scoreboard& scoreboard) {
+  for (const LeaderboardEntry& entry : scoreStore->top(SCOREBOARD_MAX_ENTRIES)) {
+    scoreboard.insert(entry);
+  }
+}
+
+/// @brief Moves the scores of a data directory that predates the score store into it,
+/// oldest first. Each win used to be saved as `SCORES/<score>_<plid>_<date>.txt`
+void TextStorage::importScoreFiles() {
+  std::vector<std::pair<time_t, LeaderboardEntry>> scores;
+
+  try {
+    for (const auto& entry : fs::directory_iterator(scoresDir)) {
+      if (!entry.is_regular_file() || entry.path().extension() != ".txt") {
+        continue;
+      }
+
+      std::string file;
+      std::string_view contents;
+      std::string_view header;
+      LeaderboardEntry score;
+      if (!readSmallFile(entry.path(), file)) continue;
+      contents = file;
+      if (!nextLine(contents, header) || !score.parse(header)) continue;
+
+      // The date follows the second underscore
+      std::string fname = entry.path().filename().string();
+      size_t sep = fname.find('_', fname.find('_') + 1);
+      std::tm tm = {};
+      std::istringstream date_ss(fname.substr(sep + 1));
+      date_ss >> std::get_time(&tm, TSTAMP_DATE_TIME_PRETTY_);
+      tm.tm_isdst = -1;
+
+      scores.emplace_back(date_ss.fail() ? 0 : std::mktime(&tm), score);
+    }
+  } catch (const std::exception& e) {
+    throw DBFilesystemError();
+  }
+
+  std::stable_sort(scores.begin(), scores.end(),
+                   [](const auto& a, const auto& b) { return a.first < b.first; });
+  for (const auto& [tstamp, score] : scores) {
+    scoreStore->append(score, tstamp);
+  }
+  scoreStore->sync();
+}
+
+/// @brief Carries out the queued operations, then flushes the score store, the history
+/// index and every file and directory written since the last sync
+void TextStorage::sync() {
+  writeQueue.flush();
+  std::lock_guard<std::mutex> sync_lock(syncMutex);
+  scoreStore->sync();
+  historyIndex.sync();
+
+  std::unordered_set<std::string> paths;
+  {
+    std::lock_guard<std::mutex> lock(dirtyMutex);
+    paths.swap(dirtyPaths);
+  }
+
+  for (const auto& path : paths) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+      if (errno == ENOENT) continue;  // Renamed away, its new path is also dirty
+      throw DBFilesystemError();
+    }
+
+    int err = fsync(fd);
+    close(fd);
+    if (err == -1) {
+      throw DBFilesystemError();
+    }
+  }
+}
+
+/// @brief Takes the failure of a player's queued operations, which the writer thread
+/// logged
+/// @param plid Player ID
+/// @return Whether an operation of the player failed since it was last asked
+bool TextStorage::writeFailed(const uint32_t plid) {
+  return writeQueue.takeFailure(plid);
+}
+
+/// @brief Returns the size of the finished games index, the only part of this layout
+/// that is a log, counting the lines still queued. Attempts are not logged to it, so
+/// `loadFrom` reads the files of the games that were active or started since instead
+/// @param pos Will store the index size
+bool TextStorage::position(uint64_t& pos) {
+  std::lock_guard<std::mutex> lock(indexMutex);
+  pos = indexSize;
+  return true;
+}
+
+/// @brief Reads a page of the finished games of a player from the history index, once
+/// the queued operations are carried out
+/// @param plid Player ID
+/// @param offset Number of most recent games to skip
+/// @param count Maximum number of games
+/// @param refs Will store the references of the games, newest first
+/// @param total Will store the number of finished games of the player
+bool TextStorage::history(const uint32_t plid, const size_t offset, const size_t count,
+                          std::vector<GameRef>& refs, size_t& total) {
+  writeQueue.flush();  // Games ended by queued operations are not in the index yet
+  total = historyIndex.read(plid, offset, count, refs);
+  return true;
+}
+
+/// @brief Starts the compactor thread
+void TextStorage::startCompactor() {
+  if (!compactorThread.joinable()) {
+    compactorThread = std::thread(&TextStorage::compactorLoop, this);
+  }
+}
+
+/// @brief Compactor thread. It first finishes moving player directories into the
+/// shards, if needed. Then every `ARCHIVE_INTERVAL` seconds it moves up to
+/// `ARCHIVE_BATCH` finished games older than `ARCHIVE_MIN_AGE` into their players'
+/// archives, so it never competes with requests for long. Only the players whose oldest
+/// loose game is past the cutoff are visited
+void TextStorage::compactorLoop() {
+  if (isMigrating) {
+    migratePlayerDirs();
+  }
+
+  // Games left loose by previous runs. The ones ending from now on are reported by
+  // writeEnding()
+  try {
+    for (const fs::path& dir : listPlayerDirs()) {
+      std::string name = dir.filename().string();
+      if (isPlidName(name)) addCompactCandidate(strToPlid(name), "");
+    }
+  } catch (const std::exception&) {
+    // Directories missed are compacted once their players finish another game
+  }
+
+  std::unique_lock<std::mutex> lock(compactorMutex);
+
+  while (!isStopping) {
+    compactorCond.wait_for(lock, std::chrono::seconds(ARCHIVE_INTERVAL));
+    if (isStopping) break;
+    lock.unlock();
+
+    // File names start with the ending date, so they compare like timestamps
+    std::ostringstream cutoff;
+    time_t cutoff_tstamp = time(nullptr) - ARCHIVE_MIN_AGE;
+    formatTimestamp(cutoff, &cutoff_tstamp, TSTAMP_DATE_TIME_);
+
+    // Due players are taken out of the candidates, so games ending while they are
+    // compacted are added back rather than lost
+    std::vector<std::pair<uint32_t, std::string>> due;
+    {
+      std::lock_guard<std::mutex> candidates_lock(candidatesMutex);
+      for (auto it = compactCandidates.begin(); it != compactCandidates.end();) {
+        if (it->second < cutoff.str()) {
+          due.emplace_back(*it);
+          it = compactCandidates.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
+
+    size_t budget = ARCHIVE_BATCH;
+    for (const auto& [plid, oldest] : due) {
+      if (budget == 0 || isStopping) {
+        addCompactCandidate(plid, oldest);
+        continue;
+      }
+
+      try {
+        std::string oldest_left;
+        budget -= compactPlayer(playerDir(plid), cutoff.str(), budget, oldest_left);
+        if (!oldest_left.empty()) addCompactCandidate(plid, oldest_left);
+      } catch (const std::exception&) {
+        addCompactCandidate(plid, oldest);  // Left for the next pass
+      }
+    }
+
+    lock.lock();
+  }
+}
+
+/// @brief Records that a player has loose finished games, keeping the oldest known
+/// @param plid Player ID
+/// @param oldest File name of the player's oldest loose game ("" if unknown)
+void TextStorage::addCompactCandidate(const uint32_t plid, const std::string& oldest) {
+  std::lock_guard<std::mutex> lock(candidatesMutex);
+  auto [it, inserted] = compactCandidates.emplace(plid, oldest);
+  if (!inserted && oldest < it->second) {
+    it->second = oldest;
+  }
+}
+
+/// @brief Archives, cold encoded, the finished games of a player that ended before a
+/// cutoff date
+/// @param dir Player directory
+/// @param cutoff Cutoff date (YYYYMMDD_HHMMSS)
+/// @param max_games Maximum number of games to archive
+/// @param oldest_left Will store the file name of the oldest game left loose ("" if
+/// none)
+/// @return Number of archived games
+size_t TextStorage::compactPlayer(const fs::path& dir, const std::string& cutoff,
+                                  const size_t max_games, std::string& oldest_left) {
+  std::vector<fs::path> paths;
+  oldest_left.clear();
+  for (const auto& entry : fs::directory_iterator(dir)) {
+    if (!entry.is_regular_file() || entry.path().extension() != ".txt") continue;
+
+    std::string name = entry.path().filename().string();
+    if (name < cutoff) {
+      paths.push_back(entry.path());
+    } else if (oldest_left.empty() || name < oldest_left) {
+      oldest_left = name;
+    }
+  }
+  if (paths.empty()) return 0;
+
+  std::sort(paths.begin(), paths.end());
+  if (paths.size() > max_games) {
+    oldest_left = paths[max_games].filename().string();
+    paths.resize(max_games);
+  }
+
+  std::vector<ArchivedGame> games;
+  games.reserve(paths.size());
+  std::string contents;
+  for (const fs::path& path : paths) {
+    if (!readSmallFile(path, contents)) {
+      throw DBFilesystemError();
+    }
+
+    Game game;
+    try {
+      game.parseGame(contents);
+      games.emplace_back(path.filename().string(), encodeColdGame(game));
+    } catch (const std::exception&) {
+      games.emplace_back(path.filename().string(), contents);
+    }
+  }
+
+  ArchiveIndex appended;
+  appendToArchive(dir, games, appended);
+  {
+    // Loaded indexes are extended, the others are loaded whole on their first read
+    std::lock_guard<std::mutex> lock(archiveMutex);
+    auto it = archiveIndexes.find(strToPlid(dir.filename().string()));
+    if (it != archiveIndexes.end()) {
+      for (auto& [name, entry] : appended) {
+        it->second[name] = entry;
+      }
+    }
+  }
+
+  // Readers that miss a removed file find it in the archive
+  for (const fs::path& path : paths) {
+    fs::remove(path);
+  }
+  markDirty(dir);
+  return paths.size();
+}
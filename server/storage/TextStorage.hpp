@@ -0,0 +1,143 @@
+#ifndef SERVER_TEXT_STORAGE_HPP
+#define SERVER_TEXT_STORAGE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "Archive.hpp"
+#include "HistoryIndex.hpp"
+#include "ScoreStore.hpp"
+#include "Storage.hpp"
+#include "WriteQueue.hpp"
+
+#define TEXT_INDEX_HEADER "FINISHED 4"
+#define TEXT_MIGRATION_MARKER "MIGRATING"  // In `GAMES/` until the migration completes
+
+/// Original storage layout: one text file per active game and finished games moved to the
+/// player's directory, both in the player's shard `GAMES/<xx>/<yy>/` (digits 5-6 and 3-4
+/// of the PLID, so no directory holds more than 100 entries). Trees from before the
+/// shards are migrated online. Wins are kept in the `SCORES/SCORES.dat` score store.
+/// Every finished game and score is also logged to the `GAMES/FINISHED.idx` append-only
+/// index (`<plid> <end timestamp> <ending> <attempts>` and `S <score header>` lines, plus
+/// `P <plid> <totals>` lines once compacted), so startup doesn't have to scan the
+/// directories. New games are logged too (`G <plid>`), so a restart from a snapshot only
+/// reads the game files of the players whose game was active or started since.
+/// Finished games older than `ARCHIVE_MIN_AGE` are packed in the background into one
+/// archive per player, to keep the number of files down. The finished games of
+/// each player are listed in order in `HISTORY/`.
+/// Requests only queue their file operations, which are carried out in order by the
+/// storage's writer thread (one index flush per batch)
+class TextStorage : public Storage {
+ private:
+  std::filesystem::path gamesDir;
+  std::filesystem::path scoresDir;
+  std::filesystem::path indexPath;
+  std::unique_ptr<ScoreStore> scoreStore;
+  HistoryIndex historyIndex;
+
+  std::mutex indexMutex;
+  std::ofstream indexFile;
+  uint64_t indexSize = 0;  // Bytes written to the index, its log position
+
+  // Files and directories written since the last sync
+  std::mutex dirtyMutex;
+  std::unordered_set<std::string> dirtyPaths;
+  // Held for a whole sync, so a concurrent one can't return before the paths it took away
+  // are flushed
+  std::mutex syncMutex;
+
+  std::mutex compactorMutex;
+  std::condition_variable compactorCond;
+  std::atomic<bool> isStopping = false;
+  std::thread compactorThread;
+
+  // Players that may have finished games not archived yet, with the file name of the
+  // oldest one ("" if unknown). Filled by one scan when the compactor starts and then as
+  // games end, so compaction passes don't list every player directory
+  std::mutex candidatesMutex;
+  std::unordered_map<uint32_t, std::string> compactCandidates;
+
+  // Archive indexes, loaded on the first read of a player's archived games and extended
+  // by the compactor as it archives more
+  std::mutex archiveMutex;
+  std::unordered_map<uint32_t, ArchiveIndex> archiveIndexes;
+
+  // Player directories may still be directly under `GAMES/`, from before the shards. The
+  // migration marker file keeps telling so across restarts until they are all moved
+  std::atomic<bool> isMigrating = false;
+
+  WriteQueue<std::function<void()>> writeQueue;
+
+  std::filesystem::path shardDir(const uint32_t plid);
+  std::filesystem::path makeShardDir(const uint32_t plid);
+  std::filesystem::path activeGamePath(const uint32_t plid);
+  std::filesystem::path playerDir(const uint32_t plid);
+  std::vector<std::filesystem::path> listPlayerDirs();
+  void migratePlayerDirs();
+  void markDirty(const std::filesystem::path& path);
+  std::string finishedGameName(const GameRef ref);
+  void loadActiveGames(std::unordered_map<uint32_t, Game>& active_games);
+  void reloadActiveGames(std::unordered_map<uint32_t, Game>& active_games,
+                         const std::vector<uint32_t>& started);
+  void setMigrating(const bool migrating);
+  bool readIndex(const uint64_t offset,
+                 std::unordered_map<uint32_t, GameRef>& last_finished,
+                 std::unordered_map<uint32_t, PlayerStats>& stats,
+                 Scoreboard& scoreboard, size_t& lines, std::vector<uint32_t>& started);
+  void rebuildIndex(std::unordered_map<uint32_t, GameRef>& last_finished,
+                    std::unordered_map<uint32_t, PlayerStats>& stats);
+  void rebuildHistory();
+  void writeIndex(const std::unordered_map<uint32_t, GameRef>& last_finished,
+                  const std::unordered_map<uint32_t, PlayerStats>& stats,
+                  Scoreboard& scoreboard);
+  bool parseStoredGame(const std::string& contents, Game& game);
+  bool findArchived(const uint32_t plid, const std::filesystem::path& dir,
+                    const std::string& name, ArchiveEntry& entry);
+  void openIndex();
+  void appendIndex(const std::string& line);
+  void reserveIndex(const std::string& line);
+  void writeBatch(std::vector<std::function<void()>>& batch, std::vector<bool>& failed);
+  void writeGame(const Game& game);
+  void writeAttempt(const Game& game, const Attempt& attempt);
+  void writeEnding(const Game& game, const Endings reason, const time_t tstamp,
+                   const int used_time, const std::string& index_line);
+  void loadScores(Scoreboard& scoreboard);
+  void importScoreFiles();
+  void startCompactor();
+  void compactorLoop();
+  void addCompactCandidate(const uint32_t plid, const std::string& oldest);
+  size_t compactPlayer(const std::filesystem::path& dir, const std::string& cutoff,
+                       const size_t max_games, std::string& oldest_left);
+
+ public:
+  TextStorage(const std::filesystem::path& dir, Logger& logger);
+  ~TextStorage();
+
+  void load(std::unordered_map<uint32_t, Game>& active_games,
+            std::unordered_map<uint32_t, GameRef>& last_finished,
+            std::unordered_map<uint32_t, PlayerStats>& stats,
+            Scoreboard& scoreboard) override;
+  void createGame(const Game& game) override;
+  void addAttempt(const Game& game, const Attempt& attempt) override;
+  GameRef endGame(const Game& game, const Endings reason, const time_t& tstamp,
+                  const int used_time) override;
+  void saveScore(const LeaderboardEntry& entry, const time_t& tstamp) override;
+  void readFinishedGame(const uint32_t plid, const GameRef ref, Game& game) override;
+  void sync() override;
+  bool writeFailed(const uint32_t plid) override;
+  bool position(uint64_t& pos) override;
+  bool loadFrom(const uint64_t pos, std::unordered_map<uint32_t, Game>& active_games,
+                std::unordered_map<uint32_t, GameRef>& last_finished,
+                std::unordered_map<uint32_t, PlayerStats>& stats,
+                Scoreboard& scoreboard) override;
+  bool history(const uint32_t plid, const size_t offset, const size_t count,
+               std::vector<GameRef>& refs, size_t& total) override;
+};
+
+#endif
@@ -0,0 +1,227 @@
+#ifndef SERVER_WRITE_QUEUE_HPP
+#define SERVER_WRITE_QUEUE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "../../common/Logger.hpp"
+#include "../../common/constants.hpp"
+#include "../Game.hpp"
+
+/// Write-behind queue of a storage backend. Requests push the records of their writes
+/// and return, while a writer thread pops them in order and hands them to the backend in
+/// batches of up to `WRITE_BATCH_MAX`. Pushing is lock-free (intrusive MPSC list): a
+/// producer only takes the wakeup mutex when the writer is sleeping. `flush` waits for
+/// every record pushed before it, which is how reads and syncs see earlier writes.
+/// Every record belongs to a player. A record the backend fails to write is logged and
+/// charged to that player only, whose next commit then reports it (`takeFailure`)
+template <typename T>
+class WriteQueue {
+ private:
+  struct Fence {
+    bool done = false;
+  };
+
+  struct Node {
+    T item{};
+    uint32_t owner = 0;         // Player the record belongs to
+    const char* op = nullptr;  // What the record does, for the log
+    Fence* fence = nullptr;  // Set on flush markers, which carry no item
+    std::atomic<Node*> next = nullptr;
+  };
+
+  std::function<void(std::vector<T>&, std::vector<bool>&)> write;
+  Logger& logger;
+
+  std::atomic<Node*> tail;  // Last pushed node, shared by the producers
+  Node* head;               // Already consumed node, owned by the writer
+
+  std::atomic<uint64_t> pushedCount = 0;
+  std::atomic<uint64_t> writtenCount = 0;
+
+  std::mutex failedMutex;
+  std::unordered_set<uint32_t> failedOwners;  // Players with a failed record unreported
+
+  std::mutex wakeMutex;
+  std::condition_variable wakeCond;
+  std::atomic<bool> isIdle = false;
+  std::atomic<bool> isStopping = false;
+
+  std::mutex fenceMutex;
+  std::condition_variable fenceCond;
+
+  std::thread writer;
+
+  /// @brief Links a node after the current tail and wakes the writer if it sleeps
+  void link(Node* node) {
+    Node* prev = tail.exchange(node);
+    prev->next.store(node);
+
+    if (isIdle.load()) {
+      std::lock_guard<std::mutex> lock(wakeMutex);
+      wakeCond.notify_one();
+    }
+  }
+
+  /// @brief Logs the records of a batch that were not written and charges them to their
+  /// players
+  /// @param owners Player of each record
+  /// @param ops Operation of each record
+  /// @param failed Whether each record failed
+  void reportFailures(const std::vector<uint32_t>& owners,
+                      const std::vector<const char*>& ops,
+                      const std::vector<bool>& failed) {
+    for (size_t i = 0; i < failed.size(); ++i) {
+      if (!failed[i]) continue;
+
+      std::ostringstream msg;
+      msg << "Could not write the " << ops[i] << " of player " << plidToStr(owners[i]);
+      logger.log(Logger::Severity::ERROR, msg.str(), true);
+
+      std::lock_guard<std::mutex> lock(failedMutex);
+      failedOwners.insert(owners[i]);
+    }
+  }
+
+  /// @brief Writer thread. Writes the records in batches, then releases the flushes
+  /// that were waiting behind them
+  void writerLoop() {
+    std::vector<T> batch;
+    std::vector<uint32_t> owners;
+    std::vector<const char*> ops;
+    std::vector<bool> failed;
+    std::vector<Fence*> fences;
+    batch.reserve(WRITE_BATCH_MAX);
+    owners.reserve(WRITE_BATCH_MAX);
+    ops.reserve(WRITE_BATCH_MAX);
+
+    while (1) {
+      Node* next;
+      while (batch.size() < WRITE_BATCH_MAX && (next = head->next.load()) != nullptr) {
+        delete head;
+        head = next;
+        if (head->fence != nullptr) {
+          fences.push_back(head->fence);
+        } else {
+          batch.push_back(std::move(head->item));
+          owners.push_back(head->owner);
+          ops.push_back(head->op);
+        }
+      }
+
+      if (batch.empty() && fences.empty()) {
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        isIdle = true;
+        wakeCond.wait(lock,
+                      [this] { return head->next.load() != nullptr || isStopping; });
+        isIdle = false;
+
+        if (head->next.load() == nullptr) {
+          return;  // Exit thread, stopping with nothing left to write
+        }
+        continue;
+      }
+
+      if (!batch.empty()) {
+        failed.assign(batch.size(), false);
+        try {
+          write(batch, failed);
+        } catch (const std::exception&) {
+          failed.assign(batch.size(), true);  // None of the batch is known to be written
+        }
+        // Charged before the fences are released, so the flushes behind them see it
+        reportFailures(owners, ops, failed);
+        writtenCount += batch.size();
+        batch.clear();
+        owners.clear();
+        ops.clear();
+      }
+
+      if (!fences.empty()) {
+        std::lock_guard<std::mutex> lock(fenceMutex);
+        for (Fence* fence : fences) fence->done = true;
+        fences.clear();
+        fenceCond.notify_all();
+      }
+    }
+  }
+
+ public:
+  /// @brief Dispatches the writer thread
+  /// @param write Writes a batch of records, in push order, and flags the records it
+  /// could not write (throwing flags the whole batch)
+  /// @param logger Logger the failed records are reported to
+  WriteQueue(std::function<void(std::vector<T>&, std::vector<bool>&)> write,
+             Logger& logger)
+      : write(std::move(write)), logger(logger) {
+    head = new Node();
+    tail = head;
+    writer = std::thread(&WriteQueue::writerLoop, this);
+  }
+
+  ~WriteQueue() {
+    stop();
+    delete head;
+  }
+
+  WriteQueue(const WriteQueue&) = delete;
+  WriteQueue& operator=(const WriteQueue&) = delete;
+
+  /// @brief Queues a record to be written
+  /// @param owner Player the record belongs to
+  /// @param op What the record does, for the log (Ex: "attempt")
+  /// @param item Record
+  void push(const uint32_t owner, const char* op, T item) {
+    Node* node = new Node();
+    node->item = std::move(item);
+    node->owner = owner;
+    node->op = op;
+    pushedCount++;  // Counted before it can be written, so flush never misses it
+    link(node);
+  }
+
+  /// @brief Writes what is still queued and terminates the writer thread. Backends stop
+  /// the queue before closing what the writer uses
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(wakeMutex);
+      isStopping = true;
+      wakeCond.notify_one();
+    }
+
+    if (writer.joinable()) {
+      writer.join();
+    }
+  }
+
+  /// @brief Waits until every record pushed before this call is written (or failed).
+  /// Returns right away if there is nothing in flight
+  void flush() {
+    if (writtenCount.load() != pushedCount.load()) {
+      Fence fence;
+      Node* node = new Node();
+      node->fence = &fence;
+      link(node);
+
+      std::unique_lock<std::mutex> lock(fenceMutex);
+      fenceCond.wait(lock, [&fence] { return fence.done; });
+    }
+  }
+
+  /// @brief Takes a player's failed records, once the records are flushed
+  /// @param owner Player ID
+  /// @return Whether a record of the player failed since it was last asked
+  bool takeFailure(const uint32_t owner) {
+    std::lock_guard<std::mutex> lock(failedMutex);
+    return failedOwners.erase(owner) != 0;
+  }
+};
+
+#endif
@@ -0,0 +1,115 @@
+#include "ChaCha20Rng.hpp"
+
+#include <sys/random.h>
+
+#include <cerrno>
+
+#include "../../common/constants.hpp"
+#include "../exceptions/ServerExceptions.hpp"
+
+static inline uint32_t rotl(const uint32_t x, const int n) {
+  return (x << n) | (x >> (32 - n));
+}
+
+static inline void quarterRound(uint32_t& a, uint32_t& b, uint32_t& c, uint32_t& d) {
+  a += b;
+  d = rotl(d ^ a, 16);
+  c += d;
+  b = rotl(b ^ c, 12);
+  a += b;
+  d = rotl(d ^ a, 8);
+  c += d;
+  b = rotl(b ^ c, 7);
+}
+
+/// @brief Creates a generator seeded from the kernel
+ChaCha20Rng::ChaCha20Rng() { reseed(); }
+
+/// @brief Replaces the key and nonce with fresh bytes from `getrandom()` and restarts
+/// the block counter
+void ChaCha20Rng::reseed() {
+  uint32_t seed[12];  // 256 bit key, 64 bit counter and 64 bit nonce
+  uint8_t* seed_bytes = reinterpret_cast<uint8_t*>(seed);
+  size_t filled = 0;
+
+  while (filled < sizeof(seed)) {
+    ssize_t n = getrandom(seed_bytes + filled, sizeof(seed) - filled, 0);
+    if (n == -1) {
+      if (errno == EINTR) continue;
+      throw RandomSourceError();
+    }
+    filled += static_cast<size_t>(n);
+  }
+
+  // "expand 32-byte k"
+  state[0] = 0x61707865;
+  state[1] = 0x3320646e;
+  state[2] = 0x79622d32;
+  state[3] = 0x6b206574;
+  for (size_t i = 0; i < 8; ++i) state[4 + i] = seed[i];
+  state[12] = 0;
+  state[13] = 0;
+  state[14] = seed[10];
+  state[15] = seed[11];
+
+  blockPos = block.size();
+  sinceReseed = 0;
+}
+
+/// @brief Generates the next 64 bytes of keystream
+void ChaCha20Rng::refill() {
+  std::array<uint32_t, 16> x = state;
+
+  for (int i = 0; i < 10; ++i) {
+    // Column rounds
+    quarterRound(x[0], x[4], x[8], x[12]);
+    quarterRound(x[1], x[5], x[9], x[13]);
+    quarterRound(x[2], x[6], x[10], x[14]);
+    quarterRound(x[3], x[7], x[11], x[15]);
+    // Diagonal rounds
+    quarterRound(x[0], x[5], x[10], x[15]);
+    quarterRound(x[1], x[6], x[11], x[12]);
+    quarterRound(x[2], x[7], x[8], x[13]);
+    quarterRound(x[3], x[4], x[9], x[14]);
+  }
+
+  for (size_t i = 0; i < 16; ++i) {
+    uint32_t word = x[i] + state[i];
+    block[4 * i] = static_cast<uint8_t>(word);
+    block[4 * i + 1] = static_cast<uint8_t>(word >> 8);
+    block[4 * i + 2] = static_cast<uint8_t>(word >> 16);
+    block[4 * i + 3] = static_cast<uint8_t>(word >> 24);
+  }
+
+  // 64 bit block counter
+  if (++state[12] == 0) ++state[13];
+  blockPos = 0;
+}
+
+/// @brief Returns the next random byte
+uint8_t ChaCha20Rng::nextByte() {
+  if (sinceReseed >= CSPRNG_RESEED_BYTES) {
+    reseed();
+  }
+
+  if (blockPos == block.size()) {
+    refill();
+  }
+
+  ++sinceReseed;
+  return block[blockPos++];
+}
+
+/// @brief Returns a uniformly distributed value in `[0, bound)`. Bytes in the incomplete
+/// range at the top are rejected, so there is no modulo bias
+/// @param bound Exclusive upper bound (1 to 256)
+uint8_t ChaCha20Rng::uniform(const uint8_t bound) {
+  const unsigned limit = 256 - (256 % bound);
+
+  while (1) {
+    uint8_t byte = nextByte();
+    if (byte < limit) {
+      return static_cast<uint8_t>(byte % bound);
+    }
+  }
+}
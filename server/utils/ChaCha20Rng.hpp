@@ -0,0 +1,28 @@
+#ifndef SERVER_CHACHA20_RNG_HPP
+#define SERVER_CHACHA20_RNG_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/// ChaCha20 keystream used as a CSPRNG. It is seeded from `getrandom()` and reseeded
+/// after every `CSPRNG_RESEED_BYTES` bytes of output, so only the reseeds cost a
+/// syscall. Not thread-safe: each thread must have its own instance
+class ChaCha20Rng {
+ private:
+  std::array<uint32_t, 16> state;
+  std::array<uint8_t, 64> block;
+  size_t blockPos;
+  size_t sinceReseed;
+
+  void reseed();
+  void refill();
+
+ public:
+  ChaCha20Rng();
+
+  uint8_t nextByte();
+  uint8_t uniform(const uint8_t bound);
+};
+
+#endif
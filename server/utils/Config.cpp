@@ -7,12 +7,24 @@ Config::Config(int argc, char** argv) {
   int opt;
   this->fpath = std::string(argv[0]);
 
-  while ((opt = getopt(argc, argv, "p:vh")) != -1) {
+  while ((opt = getopt(argc, argv, "p:s:d:c:vh")) != -1) {
     switch (opt) {
       case 'p':
         this->setPort(std::string(optarg));
         break;
 
+      case 's':
+        this->setStorage(std::string(optarg));
+        break;
+
+      case 'd':
+        this->setDurability(std::string(optarg));
+        break;
+
+      case 'c':
+        this->setCacheBudget(std::string(optarg));
+        break;
+
       case 'v':
         this->setVerbose();
         break;
@@ -49,12 +61,48 @@ void Config::setPort(const std::string& port_str) {
   }
 }
 
+/// @brief Sets the storage backend
+/// @param storage_str Storage name (text | memory | journal)
+void Config::setStorage(const std::string& storage_str) {
+  this->storage = strToStorageType(storage_str);
+}
+
+/// @brief Sets the durability mode
+/// @param durability_str Durability mode name (none | sync | group)
+void Config::setDurability(const std::string& durability_str) {
+  this->durability = strToDurabilityMode(durability_str);
+}
+
+/// @brief Sets the memory budget of the finished games cache
+/// @param budget_str Budget in KiB (`0` disables the cache)
+void Config::setCacheBudget(const std::string& budget_str) {
+  try {
+    size_t pos;
+    long long budget = std::stoll(budget_str, &pos);
+
+    if (pos != budget_str.size() || budget < 0) {
+      throw std::out_of_range("");
+    }
+
+    this->cacheBudget = static_cast<size_t>(budget) * 1024;
+  } catch (const std::exception& e) {
+    throw InvalidCacheBudgetException();
+  }
+}
+
 /// @brief Prints the GS usage
 /// @param s Output stream
 void Config::printUsage(std::ostream& s) {
-  s << "Usage: " << this->fpath << " [-p <GSport>] [-v] [-h]" << std::endl;
+  s << "Usage: " << this->fpath
+    << " [-p <GSport>] [-s <storage>] [-d <durability>] [-c <KiB>] [-v] [-h]"
+    << std::endl;
   s << "Options:" << std::endl;
   s << "\t-p <GSport>\t Sets Game server port" << std::endl;
+  s << "\t-s <storage>\t Sets the storage backend (text | memory | journal)" << std::endl;
+  s << "\t-d <durability> Sets when writes are flushed (none | sync | group)"
+    << std::endl;
+  s << "\t-c <KiB>\t Sets the memory budget of the STR cache (0 disables it)"
+    << std::endl;
   s << "\t-v\t\t Enables verbose mode" << std::endl;
   s << "\t-h\t\t Displays this usage message" << std::endl;
 }
\ No newline at end of file
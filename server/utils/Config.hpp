@@ -8,6 +8,8 @@
 
 #include "../../common/constants.hpp"
 #include "../../common/exceptions/ConfigExceptions.hpp"
+#include "../storage/Durability.hpp"
+#include "../storage/Storage.hpp"
 
 class Config {
  public:
@@ -16,10 +18,16 @@ class Config {
   std::string port = DEFAULT_PORT;
   std::string fpath;
   std::string dataPath = DEFAULT_DATA_PATH;
+  StorageType storage = StorageType::TEXT;
+  DurabilityMode durability = DurabilityMode::NONE;
+  size_t cacheBudget = GAME_CACHE_BUDGET_KB * 1024;  // Bytes
 
   Config(int argc, char** argv);
   void setPort(const std::string& portStr);
   void setVerbose();
+  void setStorage(const std::string& storage_str);
+  void setDurability(const std::string& durability_str);
+  void setCacheBudget(const std::string& budget_str);
   void printUsage(std::ostream& s);
 };
 
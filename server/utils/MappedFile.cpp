@@ -0,0 +1,60 @@
+#include "MappedFile.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// @brief Maps a file. Empty files are opened with an empty view, as they cannot be
+/// mapped
+/// @param path File path
+MappedFile::MappedFile(const std::filesystem::path& path) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) return;
+
+  struct stat st;
+  if (fstat(fd, &st) == 0) {
+    size_t len = static_cast<size_t>(st.st_size);
+    void* addr = len == 0 ? nullptr : mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (addr != MAP_FAILED) {
+      if (addr != nullptr) madvise(addr, len, MADV_SEQUENTIAL);
+      data = static_cast<const char*>(addr);
+      size = len;
+      opened = true;
+    }
+  }
+  close(fd);  // The mapping outlives the descriptor
+}
+
+/// @brief Unmaps the file
+MappedFile::~MappedFile() {
+  if (data != nullptr) munmap(const_cast<char*>(data), size);
+}
+
+/// @brief Reads a whole file into a buffer sized from `fstat()`
+/// @param path File path
+/// @param contents Will store the file's contents
+/// @return `false` if the file could not be opened or read
+bool readSmallFile(const std::filesystem::path& path, std::string& contents) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) return false;
+
+  struct stat st;
+  bool ok = fstat(fd, &st) == 0;
+  size_t len = 0;
+  if (ok) {
+    contents.resize(static_cast<size_t>(st.st_size));
+    while (len < contents.size()) {
+      ssize_t n = read(fd, &contents[len], contents.size() - len);
+      if (n <= 0) {
+        ok = n == 0;  // Shorter than when it was stat'ed
+        break;
+      }
+      len += static_cast<size_t>(n);
+    }
+    contents.resize(len);
+  }
+  close(fd);
+  return ok;
+}
@@ -0,0 +1,33 @@
+#ifndef SERVER_MAPPED_FILE_HPP
+#define SERVER_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+/// Read-only, private memory mapping of a whole file, so it can be parsed in place
+/// without copying it into streams or strings. The file must not be truncated while
+/// mapped (files are only ever appended to or replaced by a rename)
+class MappedFile {
+ private:
+  const char* data = nullptr;
+  size_t size = 0;
+  bool opened = false;
+
+ public:
+  MappedFile(const std::filesystem::path& path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  bool isOpen() const { return opened; };
+  std::string_view view() const { return std::string_view(data, size); };
+};
+
+/// Reads a whole small file (a game or score file, a few hundred bytes). At that size a
+/// single `read()` costs less than setting up and tearing down a mapping
+bool readSmallFile(const std::filesystem::path& path, std::string& contents);
+
+#endif
@@ -0,0 +1,71 @@
+#include "TimingWheel.hpp"
+
+#include <algorithm>
+
+/// @brief Creates an empty timing wheel
+/// @param now First tick of the wheel
+TimingWheel::TimingWheel(const time_t now) : current(now) {}
+
+/// @brief Puts a timer in the lowest level where its deadline is less than a full
+/// rotation of slots away. Overdue timers go into the next tick. The wheel lock must be
+/// held
+/// @param timer Timer to place
+void TimingWheel::place(Timer&& timer) {
+  time_t deadline = std::max(timer.deadline, current);
+  time_t span = 1;  // Seconds covered by one slot of the level
+
+  for (size_t level = 0; level < TIMING_WHEEL_LEVELS; ++level) {
+    if (deadline / span - current / span < TIMING_WHEEL_SLOTS) {
+      levels[level][(deadline / span) % TIMING_WHEEL_SLOTS].push_back(std::move(timer));
+      return;
+    }
+    span *= TIMING_WHEEL_SLOTS;
+  }
+
+  // Beyond the wheel's range: park it in the top level slot cascaded last, it is placed
+  // again from there
+  span /= TIMING_WHEEL_SLOTS;
+  size_t slot = (current / span + TIMING_WHEEL_SLOTS - 1) % TIMING_WHEEL_SLOTS;
+  levels[TIMING_WHEEL_LEVELS - 1][slot].push_back(std::move(timer));
+}
+
+/// @brief Schedules `key` to expire at `deadline`
+/// @param key Timer key
+/// @param deadline Expiration timestamp
+void TimingWheel::schedule(const uint32_t key, const time_t deadline) {
+  std::lock_guard<std::mutex> lock(wheelMutex);
+  place({key, deadline});
+}
+
+/// @brief Advances the wheel up to (and including) the tick `now`
+/// @param now Current timestamp
+/// @return Keys of the timers that expired
+std::vector<uint32_t> TimingWheel::advance(const time_t now) {
+  std::lock_guard<std::mutex> lock(wheelMutex);
+  std::vector<uint32_t> expired;
+
+  for (; current <= now; ++current) {
+    // Cascade the upper level slots starting at this tick, top level first
+    for (size_t level = TIMING_WHEEL_LEVELS - 1; level > 0; --level) {
+      time_t span = 1;
+      for (size_t i = 0; i < level; ++i) span *= TIMING_WHEEL_SLOTS;
+      if (current % span != 0) continue;
+
+      std::vector<Timer> timers;
+      timers.swap(levels[level][(current / span) % TIMING_WHEEL_SLOTS]);
+      for (Timer& timer : timers) place(std::move(timer));
+    }
+
+    std::vector<Timer> timers;
+    timers.swap(levels[0][current % TIMING_WHEEL_SLOTS]);
+    for (Timer& timer : timers) {
+      if (timer.deadline <= current) {
+        expired.push_back(timer.key);
+      } else {
+        place(std::move(timer));
+      }
+    }
+  }
+
+  return expired;
+}
@@ -0,0 +1,38 @@
+#ifndef SERVER_TIMING_WHEEL_HPP
+#define SERVER_TIMING_WHEEL_HPP
+
+#include <array>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <vector>
+
+#include "../../common/constants.hpp"
+
+/// Hierarchical timing wheel with a resolution of one second. Level `l` has
+/// `TIMING_WHEEL_SLOTS` slots of `TIMING_WHEEL_SLOTS^l` seconds each. Timers are
+/// cascaded to the level below when their slot comes up, so scheduling and expiring are
+/// O(1) regardless of how many timers are pending. Timers can't be cancelled: whoever
+/// consumes an expired key must check if it still applies
+class TimingWheel {
+ private:
+  struct Timer {
+    uint32_t key;
+    time_t deadline;
+  };
+
+  std::array<std::array<std::vector<Timer>, TIMING_WHEEL_SLOTS>, TIMING_WHEEL_LEVELS>
+      levels;
+  time_t current;  // Next tick to be processed
+  std::mutex wheelMutex;
+
+  void place(Timer&& timer);
+
+ public:
+  TimingWheel(const time_t now);
+
+  void schedule(const uint32_t key, const time_t deadline);
+  std::vector<uint32_t> advance(const time_t now);
+};
+
+#endif
@@ -2,7 +2,7 @@
 
 #include <iostream>
 
-/// @brief TCP worker thread, pops a connection request from the queue and executes it
+/// @brief Worker thread, pops a request from the queue and executes it
 void WorkerPool::workerThread() {
   while (1) {
     std::function<void()> connectionHandler;
@@ -44,7 +44,8 @@ WorkerPool::~WorkerPool() {
   }
 }
 
-/// @brief Enqueues a TCP connection request to be handled as soon as possible
+/// @brief Enqueues a request (TCP connection or UDP packet) to be handled as soon as
+/// possible
 /// @param connHandler
 void WorkerPool::enqueueConnection(std::function<void()> connHandler) {
   {
@@ -0,0 +1,9 @@
+#ifndef SERVER_CRC32_HPP
+#define SERVER_CRC32_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+uint32_t crc32(const unsigned char* data, size_t len);
+
+#endif
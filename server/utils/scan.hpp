@@ -0,0 +1,73 @@
+#ifndef SERVER_SCAN_HPP
+#define SERVER_SCAN_HPP
+
+#include <charconv>
+#include <string_view>
+
+// Allocation free tokenizing of text files. Views point into the scanned text, so they
+// are only valid while it is
+
+/// @brief Splits the next line off a text
+/// @param text Text, advanced past the line and its '\n'
+/// @param line Will store the line, without its '\n'
+/// @return `false` once the text is exhausted
+inline bool nextLine(std::string_view& text, std::string_view& line) {
+  if (text.empty()) return false;
+
+  size_t end = text.find('\n');
+  if (end == std::string_view::npos) {
+    line = text;
+    text.remove_prefix(text.size());
+  } else {
+    line = text.substr(0, end);
+    text.remove_prefix(end + 1);
+  }
+  return true;
+}
+
+/// @brief Whether a character separates tokens
+inline bool isBlank(const char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+/// @brief Splits the next whitespace separated token off a line
+/// @param line Line, advanced past the token
+/// @param token Will store the token
+/// @return `false` if the line holds no more tokens
+inline bool nextToken(std::string_view& line, std::string_view& token) {
+  size_t start = 0;
+  while (start < line.size() && isBlank(line[start])) start++;
+
+  size_t end = start;
+  while (end < line.size() && !isBlank(line[end])) end++;
+
+  token = line.substr(start, end - start);
+  line.remove_prefix(end);
+  return !token.empty();
+}
+
+/// @brief Parses the next token of a line as a number
+/// @param line Line, advanced past the token
+/// @param value Will store the number
+/// @return `false` if there is no token or it is not entirely a number of type `T`
+template <typename T>
+inline bool nextNumber(std::string_view& line, T& value) {
+  std::string_view token;
+  if (!nextToken(line, token)) return false;
+
+  const char* end = token.data() + token.size();
+  auto [ptr, err] = std::from_chars(token.data(), end, value);
+  return err == std::errc() && ptr == end;
+}
+
+/// @brief Parses the next token of a line as a single character
+/// @param line Line, advanced past the token
+/// @param c Will store the character
+/// @return `false` if there is no token or it is longer than one character
+inline bool nextChar(std::string_view& line, char& c) {
+  std::string_view token;
+  if (!nextToken(line, token) || token.size() != 1) return false;
+
+  c = token[0];
+  return true;
+}
+
+#endif